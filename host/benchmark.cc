@@ -0,0 +1,40 @@
+#include "check.h"
+#include "picosystem.hpp"
+#include "loader/loader.h"
+#include "audio/audio.h"
+#include <cstring>
+
+// Benchmark app built against the host stand-in, with the other apps that add
+// kernels to its suite. Runs the suite a kernel per frame, as the Loader would,
+// and prints the same CSV as the device, for comparing host and device numbers.
+
+using namespace picosystem;
+
+int main() {
+  audio.init();
+
+  App * benchmark = nullptr;
+
+  for (size_t i = 0; i < apps.size; ++i) {
+    apps.buffer[i].app->prepare();
+    if (!strcmp(apps.buffer[i].name, "Benchmark")) {
+      benchmark = apps.buffer[i].app;
+    }
+  }
+
+  CHECK(benchmark);
+  benchmark->init();
+
+  // Suite finishes on the frame after its last kernel, which prints the CSV
+  uint32_t tick = 0;
+  do {
+    benchmark->update(tick);
+    pen(0, 0, 0);
+    clear();
+    benchmark->draw(tick);
+    tick++;
+  } while (benchmark->continuous());
+  benchmark->update(tick);
+
+  return 0;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+// Stops the check with a non-zero exit status, which ctest reports as a failure
+#define CHECK(__cond)                                                             \
+  do {                                                                            \
+    if (!(__cond)) {                                                              \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #__cond); \
+      exit(1);                                                                    \
+    }                                                                             \
+  } while (0)
+
+inline uint64_t host_time_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()
+  ).count();
+}
+
+// Average ns per call of fn(i) over iterations calls. Results are folded into
+// a volatile sink, so the compiler can't drop the work.
+template <typename Fn>
+double time_ns(uint32_t iterations, Fn fn) {
+  static volatile uint32_t sink;
+  uint64_t start = host_time_ns();
+
+  for (uint32_t i = 0; i < iterations; ++i) {
+    sink = sink + (uint32_t) (int64_t) fn(i);
+  }
+
+  return (double) (host_time_ns() - start) / iterations;
+}
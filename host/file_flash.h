@@ -0,0 +1,93 @@
+#pragma once
+
+#include "check.h"
+#include "storage/storage.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Flash stand-in backed by a file, covering [base, base + size) of flash. Behaves
+// like NOR flash: erase sets whole sectors to 0xFF and program can only clear bits
+// of whole pages. Changes are written through to the file, so opening it again
+// shows what a power cycle would leave behind.
+struct FileFlash : Flash {
+  uint32_t base;
+  std::vector<uint8_t>  memory;
+  std::vector<uint32_t> erases; // Erase count of each sector
+  int32_t power_left = -1;      // Erases and programs before power is cut, -1 for never
+  FILE * file;
+
+  FileFlash(const char * path, uint32_t base, uint32_t size)
+    : base(base), memory(size, 0xFF), erases(size / STORAGE_SECTOR_SIZE, 0) {
+    file = fopen(path, "r+b");
+
+    if (file) {
+      CHECK(fread(memory.data(), 1, size, file) == size);
+    } else {
+      file = fopen(path, "w+b");
+      CHECK(file);
+      write_through(0, size);
+    }
+  }
+
+  ~FileFlash() {
+    fclose(file);
+  }
+
+  const uint8_t * data(uint32_t offset) override {
+    CHECK(offset >= base && offset - base < memory.size());
+    return memory.data() + offset - base;
+  }
+
+  void erase(uint32_t offset, uint32_t size) override {
+    CHECK(offset % STORAGE_SECTOR_SIZE == 0 && size % STORAGE_SECTOR_SIZE == 0);
+    CHECK(offset >= base && offset - base + size <= memory.size());
+
+    if (!powered()) {
+      return;
+    }
+
+    memset(memory.data() + offset - base, 0xFF, size);
+    for (uint32_t sector = 0; sector < size / STORAGE_SECTOR_SIZE; ++sector) {
+      erases[(offset - base) / STORAGE_SECTOR_SIZE + sector]++;
+    }
+    write_through(offset - base, size);
+  }
+
+  void program(uint32_t offset, const uint8_t * data, uint32_t size) override {
+    CHECK(offset % STORAGE_PAGE_SIZE == 0 && size % STORAGE_PAGE_SIZE == 0);
+    CHECK(offset >= base && offset - base + size <= memory.size());
+
+    if (!powered()) {
+      return;
+    }
+
+    for (uint32_t i = 0; i < size; ++i) {
+      memory[offset - base + i] &= data[i];
+    }
+    write_through(offset - base, size);
+  }
+
+  // Flips a bit, as a worn out or disturbed cell would
+  void corrupt(uint32_t offset) {
+    memory[offset - base] ^= 1;
+    write_through(offset - base, 1);
+  }
+
+private:
+  bool powered() {
+    if (power_left == 0) {
+      return false;
+    }
+    if (power_left > 0) {
+      power_left--;
+    }
+    return true;
+  }
+
+  void write_through(uint32_t from, uint32_t size) {
+    CHECK(fseek(file, from, SEEK_SET) == 0);
+    CHECK(fwrite(memory.data() + from, 1, size, file) == size);
+    fflush(file);
+  }
+};
@@ -0,0 +1,156 @@
+#include "check.h"
+#include "util/fill_map.h"
+#include <cstring>
+#include <queue>
+
+// FillMap::fill on 240x240 canvases against a BFS reference, with timings of
+// worst-case mazes: long single-pixel corridors that turn back on every row
+// and random noise that splits every row into many short runs.
+
+#define SIZE    240
+#define CHUNKS  (SPARSE_CHUNKS(SIZE) * SPARSE_CHUNKS(SIZE)) // Whole canvas fits
+#define REPEATS 20
+
+using Canvas = FillMap<SIZE, SIZE, CHUNKS>;
+
+static Canvas map;
+static bool reference[SIZE * SIZE];
+static bool initial[SIZE * SIZE];
+
+static void load(const bool * pixels) {
+  map.clear();
+  for (uint32_t i = 0; i < SIZE * SIZE; ++i) {
+    if (pixels[i]) {
+      CHECK(map.set(i % SIZE, i / SIZE, true));
+    }
+  }
+}
+
+// 4-connected flood fill a pixel at a time
+static void reference_fill(bool * pixels, uint32_t x, uint32_t y, bool value) {
+  if (pixels[y * SIZE + x] == value) {
+    return;
+  }
+
+  std::queue<uint32_t> queue;
+  queue.push(y * SIZE + x);
+  pixels[y * SIZE + x] = value;
+
+  while (!queue.empty()) {
+    uint32_t i = queue.front();
+    queue.pop();
+
+    int32_t px = i % SIZE, py = i / SIZE;
+    int32_t next[4][2] = {{px - 1, py}, {px + 1, py}, {px, py - 1}, {px, py + 1}};
+
+    for (auto & n : next) {
+      if (n[0] < 0 || n[0] >= SIZE || n[1] < 0 || n[1] >= SIZE || pixels[n[1] * SIZE + n[0]] == value) {
+        continue;
+      }
+      pixels[n[1] * SIZE + n[0]] = value;
+      queue.push(n[1] * SIZE + n[0]);
+    }
+  }
+}
+
+// Fills from (x, y) REPEATS times, checks result against the reference and returns best time in us
+static double run(const char * name, uint32_t x, uint32_t y, bool value) {
+  memcpy(reference, initial, sizeof(reference));
+  reference_fill(reference, x, y, value);
+
+  double best = 1e9;
+
+  for (uint32_t r = 0; r < REPEATS; ++r) {
+    load(initial);
+
+    uint64_t start = host_time_ns();
+    bool complete = map.fill(x, y, value);
+    double us = (host_time_ns() - start) / 1000.0;
+
+    CHECK(complete);
+    best = us < best ? us : best;
+  }
+
+  for (uint32_t i = 0; i < SIZE * SIZE; ++i) {
+    CHECK(map.get(i % SIZE, i / SIZE) == reference[i]);
+  }
+
+  if (name) {
+    printf("%-24s %8.1f us\n", name, best);
+  }
+  return best;
+}
+
+int main() {
+  // Empty canvas, the whole screen is one region
+  memset(initial, 0, sizeof(initial));
+  run("empty", SIZE / 2, SIZE / 2, true);
+
+  // Vertical walls on every other column, with a gap alternating between top and bottom
+  memset(initial, 0, sizeof(initial));
+  for (uint32_t x = 1; x < SIZE; x += 2) {
+    uint32_t gap = (x / 2) % 2 ? SIZE - 1 : 0;
+    for (uint32_t y = 0; y < SIZE; ++y) {
+      initial[y * SIZE + x] = y != gap;
+    }
+  }
+  run("serpentine columns", 0, 0, true);
+
+  // Same maze turned sideways, so every row holds a single long span
+  memset(initial, 0, sizeof(initial));
+  for (uint32_t y = 1; y < SIZE; y += 2) {
+    uint32_t gap = (y / 2) % 2 ? SIZE - 1 : 0;
+    for (uint32_t x = 0; x < SIZE; ++x) {
+      initial[y * SIZE + x] = x != gap;
+    }
+  }
+  run("serpentine rows", 0, 0, true);
+
+  // Erasing a canvas with a hole at every fourth pixel of every other row, so that
+  // half of the rows split into 60 runs
+  for (uint32_t i = 0; i < SIZE * SIZE; ++i) {
+    uint32_t x = i % SIZE, y = i / SIZE;
+    initial[i] = (x / 2 + y / 2) % 2 || x % 2 || y % 2;
+  }
+  run("erase lattice", 1, 1, false);
+
+  // Random noise of rising density
+  srand(1);
+  for (uint32_t density = 10; density <= 50; density += 10) {
+    double worst = 0;
+
+    for (uint32_t seed = 0; seed < 10; ++seed) {
+      for (uint32_t i = 0; i < SIZE * SIZE; ++i) {
+        initial[i] = (uint32_t) rand() % 100 < density;
+      }
+
+      uint32_t x = rand() % SIZE, y = rand() % SIZE;
+      double us = run(nullptr, x, y, !initial[y * SIZE + x]);
+      worst = us > worst ? us : worst;
+    }
+
+    printf("noise %2u%% (worst of 10)   %8.1f us\n", density, worst);
+  }
+
+  // Pool smaller than the region, fill has to fail and leave the canvas as it was,
+  // including a chunk in use that the fill went through before the pool ran out
+  static FillMap<SIZE, SIZE, 4> small;
+  small.clear();
+  for (uint32_t y = 0; y < 64; ++y) {
+    CHECK(small.set(40, y, true));
+  }
+
+  auto before = small.bitmap.data;
+  size_t used = small.bitmap.used();
+
+  CHECK(!small.fill(0, 0, true));
+  CHECK(!memcmp(&before, &small.bitmap.data, sizeof(before)));
+  CHECK(small.bitmap.used() == used);
+
+  // Pool still works after the undo
+  CHECK(small.fill(40, 0, false));
+  CHECK(small.bitmap.used() == 0);
+
+  printf("PASS\n");
+  return 0;
+}
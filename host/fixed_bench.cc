@@ -0,0 +1,65 @@
+#include "check.h"
+#include "util/fixed.h"
+#include <cmath>
+
+// fixed_t and Vec2<fixed_t> against float doing the same work, in ns per call.
+// Host FPUs make float cheap, so this shows the relative cost of the fixed-point
+// operations rather than the device's, where float is emulated in software.
+
+#define COUNT       1024 // Inputs cycled through, small enough to stay in cache
+#define ITERATIONS  2000000
+#define NEXT(__i)   (((__i) + 1) & (COUNT - 1))
+
+static float         floats[COUNT];
+static fixed_t       fixeds[COUNT];
+static Vec2<float>   float_vecs[COUNT];
+static Vec2<fixed_t> fixed_vecs[COUNT];
+
+static void compare(const char * name, double fixed_ns, double float_ns) {
+  printf("%-12s fixed %6.2f ns  float %6.2f ns\n", name, fixed_ns, float_ns);
+}
+
+int main() {
+  srand(1);
+  for (uint32_t i = 0; i < COUNT; ++i) {
+    float value = (rand() % 20000 - 10000) / 100.0f;
+    floats[i] = value ? value : 1.0f;
+    fixeds[i] = fixed_t(floats[i]);
+
+    float_vecs[i] = {(rand() % 2000 + 1) / 100.0f, (rand() % 2000 + 1) / 100.0f};
+    fixed_vecs[i] = vec_cast<fixed_t>(float_vecs[i]);
+  }
+
+  compare("mul",
+    time_ns(ITERATIONS, [](uint32_t i) { return (fixeds[i & (COUNT - 1)] * fixeds[NEXT(i)]).raw; }),
+    time_ns(ITERATIONS, [](uint32_t i) { return floats[i & (COUNT - 1)] * floats[NEXT(i)]; })
+  );
+
+  compare("div",
+    time_ns(ITERATIONS, [](uint32_t i) { return (fixeds[i & (COUNT - 1)] / fixeds[NEXT(i)]).raw; }),
+    time_ns(ITERATIONS, [](uint32_t i) { return floats[i & (COUNT - 1)] / floats[NEXT(i)]; })
+  );
+
+  compare("reciprocal",
+    time_ns(ITERATIONS, [](uint32_t i) { return reciprocal(fixeds[i & (COUNT - 1)]).raw; }),
+    time_ns(ITERATIONS, [](uint32_t i) { return 1.0f / floats[i & (COUNT - 1)]; })
+  );
+
+  compare("sqrt",
+    time_ns(ITERATIONS, [](uint32_t i) { return sqrt(abs(fixeds[i & (COUNT - 1)])).raw; }),
+    time_ns(ITERATIONS, [](uint32_t i) { return std::sqrt(std::fabs(floats[i & (COUNT - 1)])); })
+  );
+
+  compare("normalize",
+    time_ns(ITERATIONS, [](uint32_t i) { return normalize(fixed_vecs[i & (COUNT - 1)]).x.raw; }),
+    time_ns(ITERATIONS, [](uint32_t i) { return normalize(float_vecs[i & (COUNT - 1)]).x; })
+  );
+
+  compare("rotate",
+    time_ns(ITERATIONS, [](uint32_t i) { return rotate(fixed_vecs[i & (COUNT - 1)], fixeds[NEXT(i)], fixeds[i & (COUNT - 1)]).y.raw; }),
+    time_ns(ITERATIONS, [](uint32_t i) { return rotate(float_vecs[i & (COUNT - 1)], floats[NEXT(i)], floats[i & (COUNT - 1)]).y; })
+  );
+
+  printf("PASS\n");
+  return 0;
+}
@@ -0,0 +1,166 @@
+#include "check.h"
+#include "util/fixed.h"
+#include <algorithm>
+#include <cmath>
+
+// fixed_t against double: isqrt, arithmetic and rounding, reciprocal saturation,
+// normalize and rotate. Prints the worst error of each next to its tolerance.
+
+static_assert(isqrt(1000000) == 1000 && isqrt(15) == 3, "isqrt rounds down");
+static_assert(rotate(Vec2<fixed_t>{1, 0}, fixed_t(1), fixed_t(0)) == Vec2<fixed_t>{0, 1}, "rotate is constexpr");
+
+#define EPSILON (1.0 / fixed_t::ONE)
+
+static void report(const char * name, double error, double tolerance) {
+  printf("%-20s max error %.7f (tolerance %.7f)\n", name, error, tolerance);
+  CHECK(error <= tolerance);
+}
+
+static void test_isqrt() {
+  for (uint64_t v = 0; v < (1 << 20); ++v) {
+    uint64_t r = isqrt(v);
+    CHECK(r * r <= v && (r + 1) * (r + 1) > v);
+  }
+
+  // Perfect squares and their neighbours over the whole 32-bit root range
+  srand(1);
+  for (uint32_t i = 0; i < 100000; ++i) {
+    uint64_t r = ((uint64_t) rand() << 16 ^ rand()) & 0xFFFFFFFF;
+    CHECK(isqrt(r * r) == r);
+    if (r) {
+      CHECK(isqrt(r * r - 1) == r - 1);
+    }
+  }
+
+  // Random values of every width, as the 64-bit path seeds from the top bits
+  for (uint32_t i = 0; i < 100000; ++i) {
+    uint64_t v = ((uint64_t) rand() << 42 ^ (uint64_t) rand() << 21 ^ rand()) >> (i % 64);
+    uint64_t r = isqrt(v);
+    CHECK(r * r <= v && (r == 0xFFFFFFFF || (r + 1) * (r + 1) > v));
+  }
+
+  CHECK(isqrt(UINT64_MAX) == 0xFFFFFFFF);
+}
+
+static void test_arithmetic() {
+  CHECK(fixed_t(-1.5f).to_int() == -2); // Towards negative infinity
+  CHECK(fixed_t(-1.5f).fract() == fixed_t(0.5f));
+  CHECK(fixed_t(3) * fixed_t(-2.5f) == fixed_t(-7.5f));
+  CHECK(fixed_t(7) / fixed_t(2) == fixed_t(3.5f));
+  CHECK(abs(fixed_t(-3)) == fixed_t(3));
+  CHECK(sqrt(fixed_t(-1)) == fixed_t(0));
+
+  double mul = 0, div = 0, root = 0;
+
+  srand(2);
+  for (uint32_t i = 0; i < 100000; ++i) {
+    double a = (rand() % 20000 - 10000) / 100.0, b = (rand() % 20000 - 10000) / 100.0;
+    fixed_t fa(a), fb(b);
+
+    mul = std::max(mul, std::fabs((double) (fa * fb) - (double) fa * (double) fb));
+    if (std::fabs(b) >= 1) {
+      div = std::max(div, std::fabs((double) (fa / fb) - (double) fa / (double) fb));
+    }
+    if (a >= 0) {
+      root = std::max(root, std::fabs((double) sqrt(fa) - std::sqrt((double) fa)));
+    }
+  }
+
+  // Both truncate the raw result, so are off by less than one step
+  report("mul", mul, EPSILON);
+  report("div", div, EPSILON);
+  report("sqrt", root, EPSILON);
+}
+
+static void test_reciprocal() {
+  CHECK(reciprocal(fixed_t(2)) == fixed_t(0.5f));
+  CHECK(reciprocal(fixed_t(-4)) == fixed_t(-0.25f));
+
+  // Results that don't fit saturate instead of wrapping, 0 counts as positive
+  CHECK(reciprocal(fixed_t(0)) == fixed_t::max());
+  CHECK(reciprocal(fixed_t::from_raw(1)) == fixed_t::max());
+  CHECK(reciprocal(fixed_t::from_raw(-1)) == -fixed_t::max());
+  CHECK(reciprocal(fixed_t::from_raw(2)) == fixed_t::max()); // 2^15 is just out of range
+  CHECK(reciprocal(fixed_t::from_raw(3)) == fixed_t::from_raw((1ll << 32) / 3));
+  CHECK(reciprocal(fixed_t::max()) == fixed_t::from_raw(2));
+
+  // Small direction components, as the raycaster sees them at grid-aligned angles
+  for (int32_t raw = 1; raw < (1 << 12); ++raw) {
+    fixed_t r = reciprocal(fixed_t::from_raw(raw));
+    CHECK(r > 0 && r == -reciprocal(fixed_t::from_raw(-raw)));
+  }
+
+  double error = 0;
+  for (int32_t raw = fixed_t::ONE / 16; raw < 100 * fixed_t::ONE; raw += 7) {
+    fixed_t v = fixed_t::from_raw(raw);
+    error = std::max(error, std::fabs((double) reciprocal(v) - 1.0 / (double) v));
+  }
+  report("reciprocal", error, EPSILON);
+}
+
+static void test_normalize() {
+  double error2 = 0, error3 = 0;
+
+  srand(3);
+  for (uint32_t i = 0; i < 100000; ++i) {
+    // Lengths from 1/4 to about 100 tiles, length squared has to fit 16.16
+    double scale = 0.25 + (rand() % 1000) / 10.0;
+    double x = (rand() % 2001 - 1000) / 1000.0, y = (rand() % 2001 - 1000) / 1000.0, z = (rand() % 2001 - 1000) / 1000.0;
+    double l2 = std::sqrt(x * x + y * y), l3 = std::sqrt(x * x + y * y + z * z);
+
+    if (l2 < 0.5) {
+      continue;
+    }
+
+    Vec2<fixed_t> v2 = normalize(Vec2<fixed_t>{fixed_t(x * scale / l2 * 0.999), fixed_t(y * scale / l2 * 0.999)});
+    Vec3<fixed_t> v3 = normalize(Vec3<fixed_t>{fixed_t(x * scale / l3 * 0.5), fixed_t(y * scale / l3 * 0.5), fixed_t(z * scale / l3 * 0.5)});
+
+    error2 = std::max({error2, std::fabs((double) v2.x - x / l2), std::fabs((double) v2.y - y / l2)});
+    error3 = std::max({error3, std::fabs((double) v3.x - x / l3), std::fabs((double) v3.y - y / l3), std::fabs((double) v3.z - z / l3)});
+  }
+
+  // Short vectors lose most, length squared of a 1/4 tile vector keeps 12 bits
+  report("normalize vec2", error2, 0.002);
+  report("normalize vec3", error3, 0.002);
+}
+
+static void test_rotate() {
+  // Quarter turns are exact
+  Vec2<fixed_t> v = {fixed_t(3), fixed_t(-2)};
+  CHECK(rotate(v, fixed_t(1), fixed_t(0)) == (Vec2<fixed_t>{fixed_t(2), fixed_t(3)}));
+  CHECK(rotate(v, fixed_t(0), fixed_t(-1)) == -v);
+
+  double error = 0, drift = 0;
+
+  for (int32_t step = 0; step < 360; ++step) {
+    double a = step * M_PI / 180;
+    fixed_t s(std::sin(a)), c(std::cos(a));
+    Vec2<fixed_t> r = rotate(v, s, c);
+
+    error = std::max(error, std::fabs((double) r.x - (3 * std::cos(a) + 2 * std::sin(a))));
+    error = std::max(error, std::fabs((double) r.y - (3 * std::sin(a) - 2 * std::cos(a))));
+  }
+
+  // Rotating the same vector a degree at a time, as a turning player would
+  Vec2<fixed_t> p = {fixed_t(1), fixed_t(0)};
+  fixed_t s(std::sin(M_PI / 180)), c(std::cos(M_PI / 180));
+  for (int32_t step = 0; step < 360; ++step) {
+    p = rotate(p, s, c);
+  }
+  drift = std::max(std::fabs((double) p.x - 1), std::fabs((double) p.y));
+
+  // Rounding of sine and cosine, scaled up by the components of v
+  report("rotate", error, 8 * EPSILON);
+  report("rotate 360 x 1 deg", drift, 0.02);
+}
+
+int main() {
+  test_isqrt();
+  test_arithmetic();
+  test_reciprocal();
+  test_normalize();
+  test_rotate();
+
+  printf("PASS\n");
+  return 0;
+}
@@ -0,0 +1,148 @@
+#include "check.h"
+#include "audio/mixer.h"
+#include <cstring>
+#include <vector>
+
+// Renders the sounds the apps play through Mixer::render into a 16-bit mono WAV
+// file, for listening to on the host: mixer_wav [file]. Checks that every voice
+// ends silent, and prints mixing time of a block by number of active voices.
+
+#define BLOCK_SIZE  256 // Same as AUDIO_BLOCK_SIZE of the audio engine
+#define REPEATS     2000
+
+struct Cue {
+  uint32_t ms;
+  Sound    sound;
+};
+
+static int8_t sample[AUDIO_SAMPLE_RATE / 10];
+
+static std::vector<Cue> score() {
+  // Decaying square chirp as 8-bit PCM
+  for (uint32_t i = 0; i < sizeof(sample); ++i) {
+    sample[i] = (int8_t) ((i / 8 % 2 ? 100 : -100) * (sizeof(sample) - i) / sizeof(sample));
+  }
+
+  Sound chirp;
+  chirp.waveform = SAMPLE;
+  chirp.sample = sample;
+  chirp.sample_length = sizeof(sample);
+
+  std::vector<Cue> cues;
+
+  // Bounce, a rising square blip on every wall hit
+  for (uint32_t i = 0; i < 8; ++i) {
+    cues.push_back({i * 150, Sound::tone(SQUARE, 440 + i * 40, 40)});
+  }
+
+  // Raycaster bumping into a wall
+  for (uint32_t i = 0; i < 4; ++i) {
+    cues.push_back({1400 + i * 100, Sound::tone(NOISE, 1500, 30, 0x80)});
+  }
+
+  // Chord of more notes than voices, so the quietest voice is stolen
+  for (uint32_t i = 0; i < AUDIO_VOICES + 2; ++i) {
+    cues.push_back({2000 + i * 20, Sound::tone(SQUARE, 262 + i * 66, 400, 0xA0)});
+  }
+
+  cues.push_back({2800, chirp});
+  return cues;
+}
+
+static void put16(FILE * file, uint16_t value) {
+  fputc(value & 0xFF, file);
+  fputc(value >> 8, file);
+}
+
+static void put32(FILE * file, uint32_t value) {
+  put16(file, value & 0xFFFF);
+  put16(file, value >> 16);
+}
+
+static void write_wav(const char * path, const std::vector<int16_t> & pcm) {
+  FILE * file = fopen(path, "wb");
+  CHECK(file);
+
+  uint32_t bytes = pcm.size() * 2;
+  fwrite("RIFF", 1, 4, file);
+  put32(file, 36 + bytes);
+  fwrite("WAVEfmt ", 1, 8, file);
+  put32(file, 16);
+  put16(file, 1); // PCM
+  put16(file, 1); // Mono
+  put32(file, AUDIO_SAMPLE_RATE);
+  put32(file, AUDIO_SAMPLE_RATE * 2);
+  put16(file, 2);
+  put16(file, 16);
+  fwrite("data", 1, 4, file);
+  put32(file, bytes);
+
+  for (int16_t value : pcm) {
+    put16(file, value);
+  }
+
+  CHECK(fclose(file) == 0);
+}
+
+// Mixing time of one block with the given number of voices held in sustain
+static double block_us(uint32_t voices) {
+  static int16_t block[BLOCK_SIZE];
+  Mixer mixer;
+
+  for (uint32_t i = 0; i < voices; ++i) {
+    mixer.play(Sound::tone(i % 2 ? NOISE : SQUARE, 300 + i * 100, 60000));
+  }
+  CHECK(mixer.active() == voices);
+
+  return time_ns(REPEATS, [&](uint32_t) {
+    mixer.render(block, BLOCK_SIZE);
+    return block[BLOCK_SIZE - 1];
+  }) / 1000.0;
+}
+
+int main(int argc, char ** argv) {
+  const char * path = argc > 1 ? argv[1] : "mixer.wav";
+  std::vector<Cue> cues = score();
+  std::vector<int16_t> pcm;
+  Mixer mixer;
+
+  // Sounds start on block boundaries, as the audio engine only reads its queue between blocks
+  size_t cue = 0;
+  uint32_t peak = 0;
+
+  while (cue < cues.size() || mixer.active()) {
+    uint32_t ms = pcm.size() * 1000 / AUDIO_SAMPLE_RATE;
+    for (; cue < cues.size() && cues[cue].ms <= ms; ++cue) {
+      mixer.play(cues[cue].sound);
+    }
+
+    int16_t block[BLOCK_SIZE];
+    mixer.render(block, BLOCK_SIZE);
+
+    for (int16_t value : block) {
+      peak = std::max<uint32_t>(peak, value < 0 ? -value : value);
+      pcm.push_back(value);
+    }
+
+    CHECK(pcm.size() < AUDIO_SAMPLE_RATE * 10); // Some voice never ended
+  }
+
+  // Envelopes end at 0, so the last block is silent
+  CHECK(!pcm.back());
+  CHECK(peak > 0 && peak <= INT16_MAX);
+
+  write_wav(path, pcm);
+  printf("%s: %.2f s, peak %u\n", path, (double) pcm.size() / AUDIO_SAMPLE_RATE, peak);
+
+  // Mixing has to keep up with playback of the other block
+  double budget_us = BLOCK_SIZE * 1000000.0 / AUDIO_SAMPLE_RATE;
+  double idle_us = block_us(0);
+
+  for (uint32_t voices = 1; voices <= AUDIO_VOICES; ++voices) {
+    double us = block_us(voices);
+    printf("%u voices %6.2f us per block, %5.2f us per voice (budget %.0f us)\n", voices, us, (us - idle_us) / voices, budget_us);
+  }
+
+  printf("PASS\n");
+  return 0;
+}
@@ -0,0 +1,48 @@
+#include "check.h"
+#include "util/util.h"
+#include "util/sprite.h"
+#include "sprite_fixture.h" // Generated by tools/png2sprite.py from fixtures/sprite_fixture.png
+
+// tools/png2sprite.py against sprite_encode: the fixture PNG holds the pattern
+// below, with each row stored under a different PNG filter. Both encoders have
+// to produce the same rows and runs.
+
+#define W 16
+#define H 12
+
+using namespace picosystem;
+
+// Same pattern as the fixture, including alpha below and at the 4-bit cutoff
+static color_t pattern(int32_t x, int32_t y) {
+  if ((x * x + y * 3) % 7 < 2) {
+    return rgb(0, 0, 0, 0);
+  }
+
+  uint8_t a = (x + y) % 11 == 0 ? 0x0F : (x + y) % 5 == 0 ? 0x10 : 0xFF;
+  return rgb((x * 16 & 0xFF) >> 4, (y * 20 & 0xFF) >> 4, ((x + y) * 8 & 0xFF) >> 4, a >> 4);
+}
+
+int main() {
+  static color_t  data[W * H];
+  static uint16_t rows[H], runs[SPRITE_MAX_SIZE(W, H)];
+  buffer_t source;
+  Sprite sprite;
+
+  buffer_init(&source, W, H, data);
+  for (int32_t i = 0; i < W * H; ++i) {
+    data[i] = pattern(i % W, i / W);
+  }
+
+  CHECK(sprite_encode(&source, rows, runs, sizeof(runs) / sizeof(runs[0]), sprite));
+
+  CHECK(sprite_fixture.w == W && sprite_fixture.h == H);
+  CHECK(sizeof(sprite_fixture_rows) == sizeof(rows));
+  CHECK(!memcmp(sprite_fixture_rows, rows, sizeof(rows)));
+
+  size_t words = sizeof(sprite_fixture_data) / sizeof(sprite_fixture_data[0]);
+  CHECK(words <= sizeof(runs) / sizeof(runs[0]));
+  CHECK(!memcmp(sprite_fixture_data, runs, sizeof(sprite_fixture_data)));
+
+  printf("%ux%u, %u words\nPASS\n", W, H, (unsigned) words);
+  return 0;
+}
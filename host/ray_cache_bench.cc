@@ -0,0 +1,85 @@
+#include "check.h"
+#include "apps/raycaster.cc"
+
+// Raycaster draw time with and without the ray cache, under a recorded input
+// trace. Both instances get the same input, the uncached one drops its cache
+// before every frame, and their frames have to come out identical.
+
+#define PIXELS (SCREEN_SIZE * SCREEN_SIZE)
+#define B(__b) (1u << __b)
+
+struct Segment {
+  const char * name;
+  uint32_t     frames;
+  uint32_t     buttons;
+};
+
+// Typical play: looking around, walking, walking into a wall
+static const Segment trace[] = {
+  {"stand",           60, 0},
+  {"turn right",      60, B(RIGHT)},
+  {"walk",            30, B(UP)},
+  {"walk + turn",     45, B(UP) | B(LEFT)},
+  {"walk into wall",  60, B(UP)},
+  {"back off + turn", 30, B(DOWN) | B(RIGHT)},
+  {"stand",           60, 0},
+};
+
+static Raycaster cached, uncached;
+static buffer_t  cached_frame, uncached_frame;
+static color_t   cached_data[PIXELS], uncached_data[PIXELS];
+
+static uint32_t draw(Raycaster & app, buffer_t * frame, uint32_t tick) {
+  pen(0, 0, 0);
+  clear();
+
+  uint32_t start = time_us();
+  app.draw(tick);
+  uint32_t us = time_us() - start;
+
+  memcpy(frame->data, SCREEN->data, PIXELS * sizeof(color_t));
+  return us;
+}
+
+int main() {
+  audio.init();
+
+  buffer_init(&cached_frame, SCREEN_SIZE, SCREEN_SIZE, cached_data);
+  buffer_init(&uncached_frame, SCREEN_SIZE, SCREEN_SIZE, uncached_data);
+
+  for (Raycaster * app : {&cached, &uncached}) {
+    app->prepare();
+    app->init();
+    app->resolution.adaptive = false; // Same work every frame
+  }
+
+  uint32_t tick = 0;
+  printf("%-16s %6s %5s %10s %10s\n", "segment", "frames", "hits", "cached", "uncached");
+
+  for (const Segment & segment : trace) {
+    uint64_t cached_us = 0, uncached_us = 0, hits = 0, lookups = 0;
+
+    for (uint32_t frame = 0; frame < segment.frames; ++frame, ++tick) {
+      stand_in::buttons(segment.buttons);
+      cached.update(tick);
+      uncached.update(tick);
+
+      cached_us += draw(cached, &cached_frame, tick);
+      hits += cached.ray_cache.hits;
+      lookups += cached.ray_cache.lookups;
+
+      uncached.ray_cache.generation++;
+      uncached_us += draw(uncached, &uncached_frame, tick);
+
+      CHECK(!memcmp(cached_data, uncached_data, sizeof(cached_data)));
+    }
+
+    printf(
+      "%-16s %6u %4u%% %7.1f us %7.1f us\n", segment.name, segment.frames, (unsigned) (lookups ? hits * 100 / lookups : 0),
+      (double) cached_us / segment.frames, (double) uncached_us / segment.frames
+    );
+  }
+
+  printf("PASS\n");
+  return 0;
+}
@@ -0,0 +1,157 @@
+#include "check.h"
+#include "util/util.h"
+#include "util/sprite.h"
+#include <cstring>
+
+// RLE sprite_blit against the alpha-blended blit of picosystem (the stand-in's
+// per-pixel blend, as the library does it) on sprites of different shapes,
+// fully visible and clipped by the screen edge. Both have to draw the same
+// pixels. Prints encoded size and us per blit. Also checks SpriteBatch clipping
+// against sprites copied a pixel at a time.
+
+#define SIZE        32
+#define PIXELS      (SCREEN_SIZE * SCREEN_SIZE)
+#define ITERATIONS  20000
+
+using namespace picosystem;
+
+struct Shape {
+  const char * name;
+  bool (*opaque)(int32_t x, int32_t y);
+};
+
+static const Shape shapes[] = {
+  {"solid",    [](int32_t x, int32_t y) { return true; }},
+  {"disc",     [](int32_t x, int32_t y) { return (x - 16) * (x - 16) + (y - 16) * (y - 16) < 15 * 15; }},
+  {"ring",     [](int32_t x, int32_t y) { int32_t d = (x - 16) * (x - 16) + (y - 16) * (y - 16); return d < 15 * 15 && d >= 12 * 12; }},
+  {"outline",  [](int32_t x, int32_t y) { return x == 0 || y == 0 || x == SIZE - 1 || y == SIZE - 1; }},
+  {"checker",  [](int32_t x, int32_t y) { return (x + y) % 2 == 0; }}, // Worst case, a run per pixel
+};
+
+static color_t  source_data[SIZE * SIZE];
+static buffer_t source;
+static uint16_t rows[SIZE], runs[SPRITE_MAX_SIZE(SIZE, SIZE)];
+static Sprite   sprite;
+
+static color_t  blit_data[PIXELS], rle_data[PIXELS];
+static buffer_t blit_frame, rle_frame;
+
+static void background(buffer_t * frame) {
+  for (int32_t i = 0; i < PIXELS; ++i) {
+    frame->data[i] = rgb(i % 7, i % 5, i % 3);
+  }
+}
+
+// Words of data, up to the end of the last row's runs
+static uint32_t encoded_size(const Sprite & sprite) {
+  const uint16_t * run = sprite.data + sprite.rows[sprite.h - 1];
+
+  for (int32_t px = 0; px < sprite.w;) {
+    px += run[0] + run[1];
+    run += 2 + run[1];
+  }
+
+  return run - sprite.data;
+}
+
+// Draws source at each position a pixel at a time, limited to clip and the frame
+static void reference_batch(buffer_t * frame, const int32_t (*positions)[2], size_t count, SpriteClip clip) {
+  for (size_t i = 0; i < count; ++i) {
+    for (int32_t sy = 0; sy < SIZE; ++sy) {
+      for (int32_t sx = 0; sx < SIZE; ++sx) {
+        int32_t x = positions[i][0] + sx, y = positions[i][1] + sy;
+        color_t color = source_data[sy * SIZE + sx];
+
+        if ((color & rgb(0, 0, 0, 0xF)) && x >= std::max(clip.x1, 0) && x < std::min(clip.x2, SCREEN_SIZE)
+          && y >= std::max(clip.y1, 0) && y < std::min(clip.y2, SCREEN_SIZE)) {
+          *frame->p(x, y) = color;
+        }
+      }
+    }
+  }
+}
+
+// Batch of the current sprite, drawn inside, across and outside of its clip and the screen
+static void check_batch() {
+  const int32_t positions[][2] = {{40, 40}, {10, 20}, {75, 90}, {-10, -5}, {100, 110}, {95, 5}};
+  const size_t count = sizeof(positions) / sizeof(positions[0]);
+  const SpriteClip clips[] = {{20, 30, 90, 100}, {INT16_MIN, INT16_MIN, INT16_MAX, INT16_MAX}, {50, 50, 50, 80}};
+
+  for (const SpriteClip & clip : clips) {
+    SpriteBatch batch;
+    batch.clip = clip;
+    for (auto & p : positions) {
+      CHECK(batch.add(&sprite, p[0], p[1]));
+    }
+
+    background(&blit_frame);
+    background(&rle_frame);
+
+    reference_batch(&blit_frame, positions, count, clip);
+    batch.draw(&rle_frame);
+    CHECK(!memcmp(blit_data, rle_data, sizeof(blit_data)));
+  }
+
+  // Whole batch off screen leaves the frame alone
+  SpriteBatch batch;
+  CHECK(batch.add(&sprite, SCREEN_SIZE + 1, 0) && batch.add(&sprite, 0, -SIZE));
+
+  background(&blit_frame);
+  background(&rle_frame);
+  batch.draw(&rle_frame);
+  CHECK(!memcmp(blit_data, rle_data, sizeof(blit_data)));
+}
+
+int main() {
+  buffer_init(&source, SIZE, SIZE, source_data);
+  buffer_init(&blit_frame, SCREEN_SIZE, SCREEN_SIZE, blit_data);
+  buffer_init(&rle_frame, SCREEN_SIZE, SCREEN_SIZE, rle_data);
+
+  // Centered, then hanging off the left and bottom edges
+  const int32_t positions[][2] = {{44, 44}, {-10, 20}, {60, SCREEN_SIZE - 12}};
+
+  printf("%-8s %5s %8s %8s %8s\n", "sprite", "words", "pos", "blit", "rle");
+
+  for (const Shape & shape : shapes) {
+    for (int32_t y = 0; y < SIZE; ++y) {
+      for (int32_t x = 0; x < SIZE; ++x) {
+        source_data[y * SIZE + x] = shape.opaque(x, y) ? rgb(x / 2, y / 2, 0xF) : rgb(0, 0, 0, 0);
+      }
+    }
+    CHECK(sprite_encode(&source, rows, runs, sizeof(runs) / sizeof(runs[0]), sprite));
+    uint32_t words = encoded_size(sprite);
+
+    for (auto & p : positions) {
+      int32_t x = p[0], y = p[1];
+
+      background(&blit_frame);
+      background(&rle_frame);
+
+      target(&blit_frame);
+      blit(&source, 0, 0, SIZE, SIZE, x, y);
+      target();
+      sprite_blit(&rle_frame, sprite, x, y);
+
+      CHECK(!memcmp(blit_data, rle_data, sizeof(blit_data)));
+
+      target(&blit_frame);
+      double blit_us = time_ns(ITERATIONS, [&](uint32_t) {
+        blit(&source, 0, 0, SIZE, SIZE, x, y);
+        return blit_data[PIXELS / 2];
+      }) / 1000.0;
+      target();
+
+      double rle_us = time_ns(ITERATIONS, [&](uint32_t) {
+        sprite_blit(&rle_frame, sprite, x, y);
+        return rle_data[PIXELS / 2];
+      }) / 1000.0;
+
+      printf("%-8s %5u %3d,%-4d %5.2f us %5.2f us\n", shape.name, words, x, y, blit_us, rle_us);
+    }
+  }
+
+  check_batch();
+
+  printf("PASS\n");
+  return 0;
+}
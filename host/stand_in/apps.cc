@@ -0,0 +1,4 @@
+#include "loader/loader.h"
+
+// App list filled by APP(), Loader itself needs the SDK and isn't built on the host
+ApplicationList<MAX_APPS> apps;
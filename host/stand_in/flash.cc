@@ -0,0 +1,33 @@
+#include "storage/storage.h"
+#include <cstring>
+
+// Host stand-in for the onboard flash, so that apps saving to it can be built
+// on the host. Only the storage area at the end of flash is backed by memory,
+// and it starts out erased, so apps load nothing and start from scratch.
+OnboardFlash onboard_flash;
+
+static uint8_t memory[STORAGE_SIZE];
+static bool erased = false;
+
+static uint8_t * at(uint32_t offset) {
+  if (!erased) {
+    memset(memory, 0xFF, sizeof(memory));
+    erased = true;
+  }
+  return memory + (offset - STORAGE_OFFSET);
+}
+
+const uint8_t * OnboardFlash::data(uint32_t offset) {
+  return at(offset);
+}
+
+void OnboardFlash::erase(uint32_t offset, uint32_t size) {
+  memset(at(offset), 0xFF, size);
+}
+
+void OnboardFlash::program(uint32_t offset, const uint8_t * data, uint32_t size) {
+  uint8_t * dst = at(offset);
+  for (uint32_t i = 0; i < size; ++i) {
+    dst[i] &= data[i];
+  }
+}
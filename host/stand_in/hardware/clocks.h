@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+// Host stand-in, only for reporting the clock next to results. Host clock
+// isn't known, so it reads as 0
+enum clock_index {
+  clk_sys
+};
+
+inline uint32_t clock_get_hz(clock_index clock) {
+  return 0;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+
+// Host stand-in, only so that audio/audio.h compiles. Audio in stand_in/audio.cc
+// passes sounds straight to the mixer instead of queueing them for core 1
+typedef struct {
+  uint32_t unused;
+} queue_t;
@@ -0,0 +1,4 @@
+#pragma once
+
+// Host stand-in, results of a host build are labelled as such
+#define PICO_SDK_VERSION_STRING "host"
@@ -0,0 +1,243 @@
+#include "picosystem.hpp"
+#include <chrono>
+#include <cmath>
+
+#ifdef PIXEL_DOUBLE
+#define SCREEN_SIZE 120
+#else
+#define SCREEN_SIZE 240
+#endif
+
+#define GLYPH_W 6 // Font cell, including spacing
+#define GLYPH_H 8
+
+namespace picosystem {
+
+  static const auto start = std::chrono::steady_clock::now();
+
+  static color_t  screen_data[SCREEN_SIZE * SCREEN_SIZE];
+  static buffer_t screen = {SCREEN_SIZE, SCREEN_SIZE, screen_data, false};
+
+  buffer_t * SCREEN = &screen;
+  stat_t stats = {};
+
+  static buffer_t * dst = &screen;
+  static color_t    pen_color;
+  static uint32_t   held, last_held;
+
+  // Alpha blend, as the library's default blend mode. Destination keeps its alpha
+  static void blend(color_t * d, color_t s) {
+    uint32_t a = (s >> 4) & 0xF;
+
+    if (a == 0xF) {
+      *d = s;
+      return;
+    }
+
+    if (a == 0) {
+      return;
+    }
+
+    color_t out = *d & 0x00F0;
+    for (uint32_t shift : {0, 8, 12}) {
+      int32_t sc = (s >> shift) & 0xF, dc = (*d >> shift) & 0xF;
+      out |= (dc + (sc - dc) * (int32_t) a / 15) << shift;
+    }
+    *d = out;
+  }
+
+  // Horizontal run with pen color, clipped to the target
+  static void span(int32_t x, int32_t y, int32_t l) {
+    if (y < 0 || y >= dst->h) {
+      return;
+    }
+
+    int32_t x1 = x < 0 ? 0 : x;
+    int32_t x2 = x + l > dst->w ? dst->w : x + l;
+
+    for (color_t * p = dst->p(x1, y); x1 < x2; ++x1, ++p) {
+      blend(p, pen_color);
+    }
+  }
+
+  color_t rgb(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    return (r & 0xF) | ((a & 0xF) << 4) | ((b & 0xF) << 8) | ((g & 0xF) << 12);
+  }
+
+  void pen(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    pen_color = rgb(r, g, b, a);
+  }
+
+  void pen(color_t p) {
+    pen_color = p;
+  }
+
+  void target() {
+    dst = SCREEN;
+  }
+
+  void target(buffer_t * d) {
+    dst = d;
+  }
+
+  void clear() {
+    frect(0, 0, dst->w, dst->h);
+  }
+
+  void pixel(int32_t x, int32_t y) {
+    span(x, y, 1);
+  }
+
+  void hline(int32_t x, int32_t y, int32_t l) {
+    span(x, y, l);
+  }
+
+  void vline(int32_t x, int32_t y, int32_t l) {
+    for (int32_t i = 0; i < l; ++i) {
+      span(x, y + i, 1);
+    }
+  }
+
+  void rect(int32_t x, int32_t y, int32_t w, int32_t h) {
+    hline(x, y, w);
+    hline(x, y + h - 1, w);
+    vline(x, y + 1, h - 2);
+    vline(x + w - 1, y + 1, h - 2);
+  }
+
+  void frect(int32_t x, int32_t y, int32_t w, int32_t h) {
+    for (int32_t i = 0; i < h; ++i) {
+      span(x, y + i, w);
+    }
+  }
+
+  void line(int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+    int32_t dx = std::abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
+    int32_t dy = -std::abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
+    int32_t err = dx + dy;
+
+    while (true) {
+      pixel(x1, y1);
+      if (x1 == x2 && y1 == y2) {
+        break;
+      }
+
+      int32_t e2 = 2 * err;
+      if (e2 >= dy) {
+        err += dy;
+        x1 += sx;
+      }
+      if (e2 <= dx) {
+        err += dx;
+        y1 += sy;
+      }
+    }
+  }
+
+  // Half width of the ellipse at row dy from its centre
+  static int32_t ellipse_width(int32_t rx, int32_t ry, int32_t dy) {
+    return ry ? (int32_t) (rx * std::sqrt(1.0f - (float) (dy * dy) / (ry * ry)) + 0.5f) : rx;
+  }
+
+  void ellipse(int32_t x, int32_t y, int32_t rx, int32_t ry) {
+    int32_t previous = 0;
+
+    for (int32_t dy = 0; dy <= ry; ++dy) {
+      int32_t w = ellipse_width(rx, ry, dy);
+      int32_t l = dy ? std::max(previous - w, 1) : 1;
+
+      // Edge runs join rows where the outline is flat
+      for (int32_t side : {-1, 1}) {
+        span(x - w - l + 1, y + side * dy, l);
+        span(x + w, y + side * dy, l);
+      }
+      previous = w;
+    }
+  }
+
+  void fellipse(int32_t x, int32_t y, int32_t rx, int32_t ry) {
+    for (int32_t dy = -ry; dy <= ry; ++dy) {
+      int32_t w = ellipse_width(rx, ry, dy);
+      span(x - w, y + dy, 2 * w + 1);
+    }
+  }
+
+  void blit(buffer_t * src, int32_t x, int32_t y, int32_t w, int32_t h, int32_t dx, int32_t dy, uint32_t flags) {
+    for (int32_t row = 0; row < h; ++row) {
+      if (dy + row < 0 || dy + row >= dst->h || y + row < 0 || y + row >= src->h) {
+        continue;
+      }
+
+      for (int32_t col = 0; col < w; ++col) {
+        if (dx + col >= 0 && dx + col < dst->w && x + col >= 0 && x + col < src->w) {
+          blend(dst->p(dx + col, dy + row), *src->p(x + col, y + row));
+        }
+      }
+    }
+  }
+
+  void text(const std::string & t, int32_t x, int32_t y) {
+    int32_t cx = x;
+
+    for (char c : t) {
+      if (c == '\n') {
+        cx = x;
+        y += GLYPH_H;
+        continue;
+      }
+
+      if (c != ' ') {
+        rect(cx, y, GLYPH_W - 1, GLYPH_H - 1);
+      }
+      cx += GLYPH_W;
+    }
+  }
+
+  void measure(const std::string & t, int32_t & w, int32_t & h, int32_t wrap) {
+    int32_t line = 0;
+
+    w = 0;
+    h = GLYPH_H;
+
+    for (char c : t) {
+      if (c == '\n') {
+        line = 0;
+        h += GLYPH_H;
+        continue;
+      }
+
+      line += GLYPH_W;
+      w = std::max(w, line);
+    }
+  }
+
+  bool button(uint32_t b) {
+    return held & (1u << b);
+  }
+
+  bool pressed(uint32_t b) {
+    return (held & ~last_held) & (1u << b);
+  }
+
+  uint32_t time() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  uint32_t time_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  uint32_t battery() {
+    return 100;
+  }
+
+}
+
+namespace stand_in {
+
+  void buttons(uint32_t mask) {
+    picosystem::last_held = picosystem::held;
+    picosystem::held = mask;
+  }
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Host stand-in for the parts of the picosystem API used by code built on the host.
+// Same declarations as the library, implemented in picosystem.cc with plain
+// software drawing into a framebuffer of the same size as on the device.
+namespace picosystem {
+
+  typedef uint16_t color_t;
+
+  struct buffer_t {
+    int32_t w, h;
+    color_t * data;
+    bool alloc;
+
+    color_t * p(int32_t x, int32_t y) {
+      return data + x + y * w;
+    }
+  };
+
+  struct stat_t {
+    uint32_t fps;
+    uint32_t draw_us;
+    uint32_t update_us;
+    uint32_t idle;
+    uint32_t tick_us;
+  };
+
+  enum button {
+    UP = 23, DOWN = 20, LEFT = 22, RIGHT = 21, A = 18, B = 19, X = 17, Y = 16
+  };
+
+  extern buffer_t * SCREEN;
+  extern stat_t stats;
+
+  color_t rgb(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 15);
+
+  void pen(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 15);
+  void pen(color_t p);
+  void target();
+  void target(buffer_t * dst);
+
+  void clear();
+  void pixel(int32_t x, int32_t y);
+  void hline(int32_t x, int32_t y, int32_t l);
+  void vline(int32_t x, int32_t y, int32_t l);
+  void rect(int32_t x, int32_t y, int32_t w, int32_t h);
+  void frect(int32_t x, int32_t y, int32_t w, int32_t h);
+  void line(int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+  void ellipse(int32_t x, int32_t y, int32_t rx, int32_t ry);
+  void fellipse(int32_t x, int32_t y, int32_t rx, int32_t ry);
+  void blit(buffer_t * src, int32_t x, int32_t y, int32_t w, int32_t h, int32_t dx, int32_t dy, uint32_t flags = 0);
+
+  // Glyphs are boxes of the library font's cell size, good enough for layout and timing
+  void text(const std::string & t, int32_t x, int32_t y);
+  void measure(const std::string & t, int32_t & w, int32_t & h, int32_t wrap = -1);
+
+  bool button(uint32_t b);
+  bool pressed(uint32_t b);
+
+  // ms and us since start of the process
+  uint32_t time();
+  uint32_t time_us();
+
+  uint32_t battery();
+
+}
+
+// Host only: input for the next tick, as a mask of (1 << button)
+namespace stand_in {
+
+  void buttons(uint32_t mask);
+
+}
@@ -0,0 +1,196 @@
+#include "check.h"
+#include "file_flash.h"
+#include "storage/storage.h"
+#include "util/fill_map.h"
+#include <cstdlib>
+#include <cstring>
+
+// Canvas save format against a file-backed flash: round trips of Drawer and
+// Geometry canvases, slot rotation, CRC, corrupted and interrupted saves, and
+// what survives reopening the file. Prints ratio and save/load times.
+
+#define FLASH_FILE  "storage_test.bin"
+#define PIXELS      (SCREEN_SIZE * SCREEN_SIZE)
+
+using Canvas = FillMap<DRAWER_CANVAS_SIZE, DRAWER_CANVAS_SIZE, DRAWER_CANVAS_CHUNKS>;
+
+static Canvas canvas, loaded_canvas;
+static uint16_t pixels[PIXELS], loaded_pixels[PIXELS], saved[PIXELS];
+
+// Plain bitwise CRC-32, as an external tool checking a flash dump would compute it
+static uint32_t reference_crc32(const uint8_t * data, size_t size) {
+  uint32_t crc = 0xFFFFFFFF;
+
+  for (size_t i = 0; i < size; ++i) {
+    crc ^= data[i];
+    for (int32_t bit = 0; bit < 8; ++bit) {
+      crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+    }
+  }
+
+  return ~crc;
+}
+
+static void check_headers(FileFlash & flash, uint32_t offset, uint32_t slot_size) {
+  for (uint32_t slot = 0; slot < STORAGE_SLOTS; ++slot) {
+    auto header = (const Storage::Header *) flash.data(offset + slot * slot_size);
+
+    if (header->magic == STORAGE_MAGIC) {
+      CHECK(header->crc == reference_crc32(flash.data(offset + slot * slot_size + STORAGE_PAGE_SIZE), header->size));
+    }
+  }
+}
+
+static void draw_canvas(uint32_t round) {
+  canvas.clear();
+
+  // Strokes and small filled shapes, as drawn with the cursor
+  for (uint32_t i = 0; i < 8 + round * 4; ++i) {
+    uint32_t x = rand() % (SCREEN_SIZE * 2), y = rand() % (SCREEN_SIZE * 2);
+    for (uint32_t step = 0; step < 60; ++step) {
+      canvas.set(x + step, y + step / 3, true);
+    }
+  }
+
+  uint32_t x = rand() % SCREEN_SIZE, y = rand() % SCREEN_SIZE;
+  for (uint32_t i = 0; i < 20; ++i) {
+    canvas.set(x + i, y, true);
+    canvas.set(x + i, y + 19, true);
+    canvas.set(x, y + i, true);
+    canvas.set(x + 19, y + i, true);
+  }
+  canvas.fill(x + 1, y + 1, true);
+}
+
+static void draw_pixels(uint32_t round) {
+  switch (round % 4) {
+    case 0: // Black canvas with a few flat rectangles, the usual Geometry drawing
+      memset(pixels, 0, sizeof(pixels));
+      for (uint32_t r = 0; r < 6; ++r) {
+        uint16_t color = rand() % 8 * 0x1111;
+        uint32_t x = rand() % 80, y = rand() % 80;
+        for (uint32_t py = y; py < y + 30; ++py) {
+          for (uint32_t px = x; px < x + 30; ++px) {
+            pixels[py * SCREEN_SIZE + px] = color;
+          }
+        }
+      }
+      break;
+    case 1: // More colors than the palette holds
+      for (uint32_t i = 0; i < PIXELS; ++i) {
+        pixels[i] = (i / 40) % 40;
+      }
+      break;
+    case 2: // Noise, worst case
+      for (uint32_t i = 0; i < PIXELS; ++i) {
+        pixels[i] = rand();
+      }
+      break;
+    default: // Stripes
+      for (uint32_t i = 0; i < PIXELS; ++i) {
+        pixels[i] = i % SCREEN_SIZE < SCREEN_SIZE / 3 ? 0xFFFF : 0;
+      }
+      break;
+  }
+}
+
+int main() {
+  // Standard CRC-32 check value
+  CHECK(crc32((const uint8_t *) "123456789", 9) == 0xCBF43926);
+
+  remove(FLASH_FILE);
+  srand(1);
+
+  {
+    FileFlash flash(FLASH_FILE, STORAGE_OFFSET, STORAGE_SIZE);
+    Storage drawer(STORAGE_DRAWER_OFFSET, STORAGE_DRAWER_SLOT_SIZE, &flash);
+    Storage geometry(STORAGE_GEOMETRY_OFFSET, STORAGE_GEOMETRY_SLOT_SIZE, &flash);
+
+    // Blank flash holds nothing to load
+    CHECK(!drawer.load_bitmap((uint8_t *) &loaded_canvas.bitmap.data, sizeof(loaded_canvas.bitmap.data)));
+    CHECK(!geometry.load_pixels(loaded_pixels, PIXELS));
+
+    for (uint32_t round = 0; round < 8; ++round) {
+      draw_canvas(round);
+      CHECK(drawer.save_bitmap((const uint8_t *) &canvas.bitmap.data, sizeof(canvas.bitmap.data)));
+      uint32_t save_us = drawer.stats.save_us;
+
+      memset(&loaded_canvas.bitmap.data, 0, sizeof(loaded_canvas.bitmap.data));
+      CHECK(drawer.load_bitmap((uint8_t *) &loaded_canvas.bitmap.data, sizeof(loaded_canvas.bitmap.data)));
+      CHECK(loaded_canvas.bitmap.restore());
+      CHECK(!memcmp(&canvas.bitmap.data, &loaded_canvas.bitmap.data, sizeof(canvas.bitmap.data)));
+      CHECK(loaded_canvas.bitmap.used() == canvas.bitmap.used());
+
+      printf(
+        "drawer   %2u chunks  %3u%%  save %5u us  load %4u us\n",
+        (unsigned) canvas.bitmap.used(), drawer.ratio(), save_us, drawer.stats.load_us
+      );
+    }
+
+    for (uint32_t round = 0; round < 8; ++round) {
+      draw_pixels(round);
+      CHECK(geometry.save_pixels(pixels, PIXELS));
+      uint32_t save_us = geometry.stats.save_us;
+
+      memset(loaded_pixels, 0, sizeof(loaded_pixels));
+      CHECK(geometry.load_pixels(loaded_pixels, PIXELS));
+      CHECK(!memcmp(pixels, loaded_pixels, sizeof(pixels)));
+
+      printf("geometry pattern %u  %3u%%  save %5u us  load %4u us\n", round % 4, geometry.ratio(), save_us, geometry.stats.load_us);
+    }
+
+    check_headers(flash, STORAGE_DRAWER_OFFSET, STORAGE_DRAWER_SLOT_SIZE);
+    check_headers(flash, STORAGE_GEOMETRY_OFFSET, STORAGE_GEOMETRY_SLOT_SIZE);
+
+    // Saves alternate between the slots, so both wear evenly
+    uint32_t first = (STORAGE_GEOMETRY_OFFSET - STORAGE_OFFSET) / STORAGE_SECTOR_SIZE;
+    uint32_t second = first + STORAGE_GEOMETRY_SLOT_SIZE / STORAGE_SECTOR_SIZE;
+    CHECK(flash.erases[first] == 4 && flash.erases[second] == 4);
+
+    memcpy(saved, pixels, sizeof(pixels));
+  }
+
+  // Latest copy survives reopening the file
+  {
+    FileFlash flash(FLASH_FILE, STORAGE_OFFSET, STORAGE_SIZE);
+    Storage geometry(STORAGE_GEOMETRY_OFFSET, STORAGE_GEOMETRY_SLOT_SIZE, &flash);
+
+    CHECK(geometry.load_pixels(loaded_pixels, PIXELS));
+    CHECK(!memcmp(saved, loaded_pixels, sizeof(saved)));
+
+    // Power is cut a few flash operations into the next save
+    draw_pixels(2);
+    flash.power_left = 4;
+    geometry.save_pixels(pixels, PIXELS);
+  }
+
+  {
+    FileFlash flash(FLASH_FILE, STORAGE_OFFSET, STORAGE_SIZE);
+    Storage geometry(STORAGE_GEOMETRY_OFFSET, STORAGE_GEOMETRY_SLOT_SIZE, &flash);
+
+    // Interrupted save never got its header, previous copy is still the latest
+    CHECK(geometry.load_pixels(loaded_pixels, PIXELS));
+    CHECK(!memcmp(saved, loaded_pixels, sizeof(saved)));
+
+    draw_pixels(3);
+    CHECK(geometry.save_pixels(pixels, PIXELS));
+
+    // A flipped bit fails CRC of the newest copy, so the one before it is loaded
+    uint32_t newest = 0;
+    for (uint32_t slot = 1; slot < STORAGE_SLOTS; ++slot) {
+      auto a = (const Storage::Header *) flash.data(STORAGE_GEOMETRY_OFFSET + slot * STORAGE_GEOMETRY_SLOT_SIZE);
+      auto b = (const Storage::Header *) flash.data(STORAGE_GEOMETRY_OFFSET + newest * STORAGE_GEOMETRY_SLOT_SIZE);
+      if (a->magic == STORAGE_MAGIC && (int32_t) (a->sequence - b->sequence) > 0) {
+        newest = slot;
+      }
+    }
+    flash.corrupt(STORAGE_GEOMETRY_OFFSET + newest * STORAGE_GEOMETRY_SLOT_SIZE + STORAGE_PAGE_SIZE + 100);
+
+    CHECK(geometry.load_pixels(loaded_pixels, PIXELS));
+    CHECK(!memcmp(saved, loaded_pixels, sizeof(saved)));
+  }
+
+  remove(FLASH_FILE);
+  printf("PASS\n");
+  return 0;
+}
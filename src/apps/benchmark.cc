@@ -0,0 +1,207 @@
+#include "picosystem.hpp"
+#include "loader/loader.h"
+#include "util/util.h"
+#include "util/fill_map.h"
+#include "storage/storage.h"
+#include "bench/bench.h"
+#include "hardware/clocks.h"
+#include "pico/version.h"
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+#define BENCH_CANVAS_CHUNKS 16  // Pool of the map kernels, canvas is the size of Drawer's
+#define BENCH_BOX           128 // Corner of the box filled by map_fill
+#define BENCH_BOX_SIZE      64
+#define BENCH_INPUTS        64  // Vectors cycled through by fixed and float kernels
+
+using namespace picosystem;
+
+// Runs primitive and app kernels one per frame, shows ns per iteration and
+// prints the suite as CSV over stdio (USB CDC) once it completes
+struct Benchmark : App {
+  Bench suite;
+  uint32_t next;    // Kernel to run on next update
+  uint32_t first;   // First kernel on screen, UP/DOWN scroll the list
+  bool     printed; // CSV of the finished suite was printed
+
+  FillMap<DRAWER_CANVAS_SIZE, DRAWER_CANVAS_SIZE, BENCH_CANVAS_CHUNKS> map;
+  std::string sample_text = "The quick brown fox";
+
+  // Same inputs for fixed_t and float versions of a kernel, float is emulated on the device
+  Vec2<fixed_t> fixed_vecs[BENCH_INPUTS];
+  Vec2<float>   float_vecs[BENCH_INPUTS];
+
+  void init() {
+    suite.clear();
+    for (size_t i = 0; i < apps.size; ++i) {
+      apps.buffer[i].app->bench(suite);
+    }
+
+    next = 0;
+    first = 0;
+    printed = false;
+  }
+
+  void update(uint32_t tick) {
+    if (pressed(A)) {
+      init();
+    }
+
+    if (pressed(UP) && first > 0) {
+      first--;
+    }
+
+    if (pressed(DOWN) && first + 1 < suite.kernels.size) {
+      first++;
+    }
+
+    if (next < suite.kernels.size) {
+      // Drawing kernels draw to the screen, frame is cleared before draw anyway
+      pen(0xF, 0xF, 0xF);
+      suite.run(suite.kernels.buffer[next++]);
+    } else if (!printed) {
+      print_csv();
+      printed = true;
+    }
+  }
+
+  void draw(uint32_t tick) {
+    int32_t x, y;
+    measure("0", x, y);
+
+    pen(0, 0xF, 0xF);
+    text(next < suite.kernels.size ? "Running..." : "ns/iteration (A to rerun)", 1, 1);
+
+    for (size_t i = first; i < suite.kernels.size; ++i) {
+      const Bench::Kernel & kernel = suite.kernels.buffer[i];
+      int32_t row = (i - first + 1) * (y + 1) + 2;
+
+      if (row + y > SCREEN->h) {
+        break;
+      }
+
+      pen(0xF, 0xF, 0xF);
+      text(kernel.name, 1, row);
+
+      if (i < next) {
+        auto ns_str = std::to_string(Bench::ns_per_iteration(kernel));
+        measure(ns_str, x, y);
+        text(ns_str, SCREEN->w - x - 1, row);
+      }
+    }
+  }
+
+  bool continuous() const {
+    return next < suite.kernels.size;
+  }
+
+  void bench(Bench & bench) {
+    bench.add("clear", 50, [](void * ctx, uint32_t i) -> uint32_t {
+      clear();
+      return i;
+    }, this);
+
+    bench.add("pixel", 20000, [](void * ctx, uint32_t i) -> uint32_t {
+      pixel(i % SCREEN->w, i / SCREEN->w % SCREEN->h);
+      return i;
+    }, this);
+
+    bench.add("vline", 2000, [](void * ctx, uint32_t i) -> uint32_t {
+      vline(i % SCREEN->w, 0, SCREEN->h);
+      return i;
+    }, this);
+
+    bench.add("frect", 1000, [](void * ctx, uint32_t i) -> uint32_t {
+      frect(i % (SCREEN->w - 32), i / 7 % (SCREEN->h - 32), 32, 32);
+      return i;
+    }, this);
+
+    bench.add("text", 500, [](void * ctx, uint32_t i) -> uint32_t {
+      Benchmark * self = (Benchmark *) ctx;
+      text(self->sample_text, 0, i % (SCREEN->h - 8));
+      return i;
+    }, this);
+
+    // Drawer's canvas: single pixels near the origin, reads all over the canvas, mostly
+    // of empty chunks, and fill of a box outline, whose rows are cleared again afterwards
+    map.clear();
+    for (uint32_t i = 0; i < BENCH_BOX_SIZE; ++i) {
+      map.set(BENCH_BOX + i, BENCH_BOX, true);
+      map.set(BENCH_BOX + i, BENCH_BOX + BENCH_BOX_SIZE - 1, true);
+      map.set(BENCH_BOX, BENCH_BOX + i, true);
+      map.set(BENCH_BOX + BENCH_BOX_SIZE - 1, BENCH_BOX + i, true);
+    }
+
+    bench.add("map_get", 100000, [](void * ctx, uint32_t i) -> uint32_t {
+      Benchmark * self = (Benchmark *) ctx;
+      return self->map.get(i * 37 % DRAWER_CANVAS_SIZE, i * 11 % DRAWER_CANVAS_SIZE);
+    }, this);
+
+    bench.add("map_set", 100000, [](void * ctx, uint32_t i) -> uint32_t {
+      Benchmark * self = (Benchmark *) ctx;
+      return self->map.set(i * 7 % 64, i / 64 % 64, i & 1);
+    }, this);
+
+    bench.add("map_fill", 200, [](void * ctx, uint32_t i) -> uint32_t {
+      Benchmark * self = (Benchmark *) ctx;
+      bool complete = self->map.fill(BENCH_BOX + 1, BENCH_BOX + 1, true);
+
+      for (uint32_t y = BENCH_BOX + 1; y < BENCH_BOX + BENCH_BOX_SIZE - 1; ++y) {
+        self->map.bitmap.fill(y, BENCH_BOX + 1, BENCH_BOX + BENCH_BOX_SIZE - 1, false);
+      }
+      return complete;
+    }, this);
+
+    for (uint32_t i = 0; i < BENCH_INPUTS; ++i) {
+      float_vecs[i] = {(i * 37 % 2000 + 1) / 100.0f, (i * 91 % 2000 + 1) / 100.0f};
+      fixed_vecs[i] = vec_cast<fixed_t>(float_vecs[i]);
+    }
+
+    bench.add("sqrt_fixed", 10000, [](void * ctx, uint32_t i) -> uint32_t {
+      Benchmark * self = (Benchmark *) ctx;
+      return sqrt(self->fixed_vecs[i % BENCH_INPUTS].x).raw;
+    }, this);
+
+    bench.add("sqrt_float", 10000, [](void * ctx, uint32_t i) -> uint32_t {
+      Benchmark * self = (Benchmark *) ctx;
+      return float_bits(sqrtf(self->float_vecs[i % BENCH_INPUTS].x));
+    }, this);
+
+    bench.add("norm_fixed", 10000, [](void * ctx, uint32_t i) -> uint32_t {
+      Benchmark * self = (Benchmark *) ctx;
+      return normalize(self->fixed_vecs[i % BENCH_INPUTS]).x.raw;
+    }, this);
+
+    bench.add("norm_float", 10000, [](void * ctx, uint32_t i) -> uint32_t {
+      Benchmark * self = (Benchmark *) ctx;
+      return float_bits(normalize(self->float_vecs[i % BENCH_INPUTS]).x);
+    }, this);
+  }
+
+private:
+  // Result of a float kernel for the sink, without a conversion that would add to its time
+  static uint32_t float_bits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+
+  void print_csv() {
+    uint32_t clock_khz = clock_get_hz(clk_sys) / 1000;
+
+    printf("kernel,iterations,total_us,ns_per_iteration,clk_sys_khz,sdk\n");
+    for (size_t i = 0; i < suite.kernels.size; ++i) {
+      const Bench::Kernel & kernel = suite.kernels.buffer[i];
+      printf(
+        "%s,%lu,%lu,%lu,%lu,%s\n", kernel.name,
+        (unsigned long) kernel.iterations, (unsigned long) kernel.total_us,
+        (unsigned long) Bench::ns_per_iteration(kernel), (unsigned long) clock_khz, PICO_SDK_VERSION_STRING
+      );
+    }
+  }
+};
+
+static Benchmark benchmark;
+
+APP(Benchmark, &benchmark);
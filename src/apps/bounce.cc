@@ -1,6 +1,7 @@
 #include "picosystem.hpp"
 #include "loader/loader.h"
 #include "util/util.h"
+#include "audio/audio.h"
 #include <cstring>
 #include <cmath>
 
@@ -9,29 +10,44 @@ using namespace picosystem;
 #define START_ANGLE         315.0f
 #define BASE_UPDATE_ANGLE   180.0f
 #define RAND_ANGLE_FRACTION 15
+#define BOUNCE_BASE_FREQUENCY 440
 
 struct Object {
-  Vec2<float> pos;
-  float angle = START_ANGLE;
+  Vec2<fixed_t> pos;
+  Vec2<fixed_t> direction;
+  float angle;
+
+  Object() {
+    turn(START_ANGLE);
+  }
+
+  void turn(float angle) {
+    this->angle = angle;
+    direction = {fixed_t(cosf(angle)), fixed_t(sinf(angle))};
+  }
+
+  void bounce(float angle, uint32_t tick) {
+    turn(angle);
+    audio.play(Sound::tone(SQUARE, BOUNCE_BASE_FREQUENCY + (tick % RAND_ANGLE_FRACTION) * 40, 40));
+  }
 
   void update(uint32_t tick) {
-    pos.y = cap<float>(pos.y + sin(angle), 0, SCREEN->h - 1);
-    pos.x = cap<float>(pos.x + cos(angle), 0, SCREEN->w - 1);
+    pos = cap<fixed_t>(pos + direction, {0, 0}, {SCREEN->w - 1, SCREEN->h - 1});
 
     if (pos.y <= 0) {
-      angle += BASE_UPDATE_ANGLE + (tick % RAND_ANGLE_FRACTION);
+      bounce(angle + BASE_UPDATE_ANGLE + (tick % RAND_ANGLE_FRACTION), tick);
     } else if (pos.y + 1 >= SCREEN->h) {
-      angle -= BASE_UPDATE_ANGLE + (tick % RAND_ANGLE_FRACTION);
+      bounce(angle - BASE_UPDATE_ANGLE - (tick % RAND_ANGLE_FRACTION), tick);
     } else if (pos.x <= 0) {
-      angle += BASE_UPDATE_ANGLE + (tick % RAND_ANGLE_FRACTION);
+      bounce(angle + BASE_UPDATE_ANGLE + (tick % RAND_ANGLE_FRACTION), tick);
     } else if (pos.x + 1 >= SCREEN->w) {
-      angle -= BASE_UPDATE_ANGLE + (tick % RAND_ANGLE_FRACTION);
+      bounce(angle - BASE_UPDATE_ANGLE - (tick % RAND_ANGLE_FRACTION), tick);
     }
   }
 
   void draw(uint32_t tick) {
     pen(0xF, 0, 0);
-    pixel(pos.x, pos.y);
+    pixel(pos.x.to_int(), pos.y.to_int());
   }
 };
 
@@ -49,6 +65,10 @@ struct Bounce : App {
   void draw(uint32_t tick) {
     object.draw(tick);
   }
+
+  bool continuous() const {
+    return true;
+  }
 };
 
 static Bounce bounce;
@@ -1,96 +1,171 @@
 #include "picosystem.hpp"
 #include "loader/loader.h"
 #include "util/util.h"
+#include "storage/storage.h"
+#include "util/fill_map.h"
 #include <cstring>
 
-using namespace picosystem;
-
-template <size_t W, size_t H>
-struct Map {
-  Bitmap<W * H> bitmap;
-
-  size_t width() const {
-    return W;
-  }
-
-  size_t height() const {
-    return H;
-  }
+#define SCROLL_MARGIN 8 // Distance from screen edge at which view starts to scroll
 
-  void clear() {
-    bitmap.clear();
-  }
-
-  bool get(uint32_t x, uint32_t y) {
-    return bitmap.get(y * H + x);
-  }
-
-  void set(uint32_t x, uint32_t y, bool value) {
-    return bitmap.set(y * H + x, value);
-  }
-};
+using namespace picosystem;
 
 struct Player {
   Vec2<int> pos;
 
   void update(uint32_t tick) {
-    if (button(UP)) {
-      pos.y = cap<int32_t>(pos.y - 1, 0, SCREEN->h - 1);
-    }
-
-    if (button(DOWN)) {
-      pos.y = cap<int32_t>(pos.y + 1, 0, SCREEN->h - 1);
-    }
-
-    if (button(LEFT)) {
-      pos.x = cap<int32_t>(pos.x - 1, 0, SCREEN->w - 1);
-    }
-
-    if (button(RIGHT)) {
-      pos.x = cap<int32_t>(pos.x + 1, 0, SCREEN->w - 1);
-    }
+    Vec2<int> direction = {button(RIGHT) - button(LEFT), button(DOWN) - button(UP)};
+    pos = cap(pos + direction, {0, 0}, {DRAWER_CANVAS_SIZE - 1, DRAWER_CANVAS_SIZE - 1});
   }
 
-  void draw(uint32_t tick) {
+  void draw(uint32_t tick, Vec2<int> view) {
     pen(0xF, 0, 0);
-    pixel(pos.x, pos.y);
+    pixel(pos.x - view.x, pos.y - view.y);
   }
 };
 
 struct Drawer : App {
   Player player;
-  Map<SCREEN_SIZE, SCREEN_SIZE> map;
+  Vec2<int> view; // Top left corner of the screen on the canvas
+  FillMap<DRAWER_CANVAS_SIZE, DRAWER_CANVAS_SIZE, DRAWER_CANVAS_CHUNKS> map;
+  Storage storage{STORAGE_DRAWER_OFFSET, STORAGE_DRAWER_SLOT_SIZE};
+  Timeout autosave_timeout;
+
+  union {
+    uint8_t value;
+    struct {
+      bool draw_stat  : 1;
+      bool dirty      : 1;
+      bool pool_full  : 1; // Last pixel didn't fit into the chunk pool
+      bool too_large  : 1; // Last fill ran out of chunks or fill queue and was undone
+    };
+  } flags;
+
+  void prepare() {
+    if (!storage.load_bitmap((uint8_t *) &map.bitmap.data, sizeof(map.bitmap.data)) || !map.bitmap.restore()) {
+      map.clear();
+    }
+  }
 
   void init() {
     player.pos = {0, 0};
-    map.clear();
+    view = {0, 0};
+    flags.value = 0;
   }
 
   void update(uint32_t tick) {
     if (button(B)) {
-      map.set(player.pos.x, player.pos.y, true);
+      flags.pool_full = !map.set(player.pos.x, player.pos.y, true);
+      flags.too_large = false;
+      mark_dirty();
     }
 
     if (button(A)) {
-      map.set(player.pos.x, player.pos.y, false);
+      flags.pool_full = !map.set(player.pos.x, player.pos.y, false);
+      flags.too_large = false;
+      mark_dirty();
+    }
+
+    if (pressed(Y)) {
+      flags.pool_full = false;
+      flags.too_large = !map.fill(player.pos.x, player.pos.y, !map.get(player.pos.x, player.pos.y));
+      mark_dirty();
+    }
+
+    if (pressed(X)) {
+      flags.draw_stat = !flags.draw_stat;
+    }
+
+    if (flags.dirty && autosave_timeout.expired()) {
+      save();
     }
 
     player.update(tick);
+    scroll();
   }
 
-  void draw(uint32_t tick) {
-    player.draw(tick);
+  // Visits only chunks under the screen that have something drawn in them
+  void HOT_FUNC(draw)(uint32_t tick) {
+    player.draw(tick, view);
 
     pen(0, 0xF, 0xF);
 
-    for (uint32_t y = 0; y < map.height(); ++y) {
-      for (uint32_t x = 0; x < map.width(); ++x) {
-        if (map.get(x, y)) {
-          pixel(x, y);
+    int32_t cx1 = view.x / SPARSE_CHUNK_BITS, cx2 = (view.x + SCREEN->w - 1) / SPARSE_CHUNK_BITS;
+    int32_t cy1 = view.y / SPARSE_CHUNK_BITS, cy2 = (view.y + SCREEN->h - 1) / SPARSE_CHUNK_BITS;
+
+    for (int32_t cy = cy1; cy <= cy2; ++cy) {
+      for (int32_t cx = cx1; cx <= cx2; ++cx) {
+        auto chunk = map.bitmap.chunk(cx, cy);
+        if (!chunk) {
+          continue;
+        }
+
+        for (int32_t row = 0; row < SPARSE_CHUNK_BITS; ++row) {
+          int32_t y = cy * SPARSE_CHUNK_BITS + row - view.y;
+          uint32_t bits = chunk->rows[row];
+
+          if (y < 0 || y >= SCREEN->h) {
+            continue;
+          }
+
+          // Bits left of the screen land at negative x and are clipped
+          while (bits) {
+            pixel(cx * SPARSE_CHUNK_BITS + __builtin_ctz(bits) - view.x, y);
+            bits &= bits - 1;
+          }
         }
       }
     }
 
+    if (flags.draw_stat) {
+      draw_stat();
+    }
+
+    // Shown without the overlay too, otherwise drawing would just silently stop working
+    if (flags.pool_full || flags.too_large) {
+      pen(0xF, 0x4, 0);
+      text(flags.pool_full ? "pool full" : "fill too large", 5, SCREEN->h - 12);
+    }
+  }
+
+  void exit() {
+    if (flags.dirty) {
+      save();
+    }
+  }
+
+private:
+  void mark_dirty() {
+    flags.dirty = true;
+    autosave_timeout = Timeout(STORAGE_AUTOSAVE_TIMEOUT);
+  }
+
+  // Keeps cursor SCROLL_MARGIN away from screen edges, as long as view stays on the canvas
+  void scroll() {
+    Vec2<int> margin = {SCROLL_MARGIN, SCROLL_MARGIN};
+    Vec2<int> screen = {SCREEN->w, SCREEN->h};
+
+    view = cap(view, player.pos + margin + Vec2<int>{1, 1} - screen, player.pos - margin);
+    view = cap(view, {0, 0}, Vec2<int>{DRAWER_CANVAS_SIZE, DRAWER_CANVAS_SIZE} - screen);
+  }
+
+  void save() {
+    storage.save_bitmap((const uint8_t *) &map.bitmap.data, sizeof(map.bitmap.data));
+    flags.dirty = false;
+  }
+
+  void draw_stat() {
+    pen(0xF, 0xF, 0xF);
+    text(
+      "S " + std::to_string(storage.stats.save_us / 1000) + "ms"
+      " L " + std::to_string(storage.stats.load_us / 1000) + "ms"
+      " " + std::to_string(storage.ratio()) + "%",
+      5, 5
+    );
+    text(
+      std::to_string(player.pos.x) + "," + std::to_string(player.pos.y)
+      + " C " + std::to_string(map.bitmap.used()) + "/" + std::to_string(map.bitmap.capacity()),
+      5, 15
+    );
   }
 };
 
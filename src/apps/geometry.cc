@@ -1,7 +1,8 @@
 #include "picosystem.hpp"
 #include "loader/loader.h"
 #include "util/util.h"
-#include "util/util.h"
+#include "storage/storage.h"
+#include "bench/bench.h"
 #include <cstring>
 
 using namespace picosystem;
@@ -17,10 +18,14 @@ struct Geometry : App {
   buffer_t buf;
   color_t data[SCREEN_SIZE * SCREEN_SIZE];
 
+  Storage storage{STORAGE_GEOMETRY_OFFSET, STORAGE_GEOMETRY_SLOT_SIZE};
+  Timeout autosave_timeout;
+
   union {
     uint8_t value;
     struct {
       bool draw_stat : 1;
+      bool dirty     : 1;
     };
   } flags;
 
@@ -41,22 +46,13 @@ struct Geometry : App {
     }
   }
 
-  void update(uint32_t tick) {
-    if (button(UP)) {
-      pos.y = cap<int32_t>(pos.y - 1, 0, SCREEN->h - 1);
-    }
-
-    if (button(DOWN)) {
-      pos.y = cap<int32_t>(pos.y + 1, 0, SCREEN->h - 1);
-    }
-
-    if (button(LEFT)) {
-      pos.x = cap<int32_t>(pos.x - 1, 0, SCREEN->w - 1);
-    }
+  void prepare() {
+    storage.load_pixels(data, SCREEN_SIZE * SCREEN_SIZE);
+  }
 
-    if (button(RIGHT)) {
-      pos.x = cap<int32_t>(pos.x + 1, 0, SCREEN->w - 1);
-    }
+  void update(uint32_t tick) {
+    Vec2<int> direction = {button(RIGHT) - button(LEFT), button(DOWN) - button(UP)};
+    pos = cap(pos + direction, {0, 0}, {SCREEN->w - 1, SCREEN->h - 1});
 
     if (pressed(B)) {
       if (state == IDLE) {
@@ -80,6 +76,10 @@ struct Geometry : App {
     if (pressed(X)) {
       flags.draw_stat = !flags.draw_stat;
     }
+
+    if (flags.dirty && autosave_timeout.expired()) {
+      save();
+    }
   }
 
   void draw(uint32_t tick) {
@@ -89,6 +89,7 @@ struct Geometry : App {
       draw_figure();
       target();
       state = IDLE;
+      mark_dirty();
     }
 
     blit(&buf, 0, 0, buf.w, buf.h, 0, 0);
@@ -106,7 +107,36 @@ struct Geometry : App {
     pixel(pos.x, pos.y);
   }
 
+  // Blit of the whole canvas, which draw() does every frame
+  void bench(Bench & bench) {
+    if (!buf.data) {
+      buffer_init(&buf, SCREEN_SIZE, SCREEN_SIZE, data);
+    }
+
+    bench.add("blit", 200, [](void * ctx, uint32_t i) -> uint32_t {
+      Geometry * self = (Geometry *) ctx;
+      blit(&self->buf, 0, 0, self->buf.w, self->buf.h, 0, 0);
+      return i;
+    }, this);
+  }
+
+  void exit() {
+    if (flags.dirty) {
+      save();
+    }
+  }
+
 private:
+  void mark_dirty() {
+    flags.dirty = true;
+    autosave_timeout = Timeout(STORAGE_AUTOSAVE_TIMEOUT);
+  }
+
+  void save() {
+    storage.save_pixels(data, SCREEN_SIZE * SCREEN_SIZE);
+    flags.dirty = false;
+  }
+
   void cycle_action_state() {
     action_state = action_state == DRAW ? ERASE : DRAW;
   }
@@ -133,27 +163,20 @@ private:
   }
 
   void draw_figure() {
+    Vec2<int> origin = min(clicked_pos, pos);
+    Vec2<int> size = abs_diff(pos, clicked_pos);
+
     switch (figure) {
       case LINE:
         line(clicked_pos.x, clicked_pos.y, pos.x, pos.y);
         break;
       case RECT:
         case FRECT:
-        (figure == FRECT ? frect : rect)(
-          std::min(clicked_pos.x, pos.x),
-          std::min(clicked_pos.y, pos.y),
-          abs_diff(pos.x, clicked_pos.x),
-          abs_diff(pos.y, clicked_pos.y)
-        );
+        (figure == FRECT ? frect : rect)(origin.x, origin.y, size.x, size.y);
         break;
       case ELIPSIS:
         case FELIPSIS:
-        (figure == FELIPSIS ? fellipse : ellipse)(
-          std::min(clicked_pos.x, pos.x),
-          std::min(clicked_pos.y, pos.y),
-          abs_diff(pos.x, clicked_pos.x),
-          abs_diff(pos.y, clicked_pos.y)
-        );
+        (figure == FELIPSIS ? fellipse : ellipse)(origin.x, origin.y, size.x, size.y);
         break;
       default:
         break;
@@ -191,6 +214,12 @@ private:
   void draw_stat() {
     pen(0xF, 0xF, 0xF);
     text(action_state_to_str() + " " + figure_to_str(), 5, 5);
+    text(
+      "S " + std::to_string(storage.stats.save_us / 1000) + "ms"
+      " L " + std::to_string(storage.stats.load_us / 1000) + "ms"
+      " " + std::to_string(storage.ratio()) + "%",
+      5, 15
+    );
   }
 
   void set_color() const {
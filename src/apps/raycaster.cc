@@ -1,6 +1,9 @@
 #include "picosystem.hpp"
 #include "loader/loader.h"
 #include "util/util.h"
+#include "util/sprite.h"
+#include "audio/audio.h"
+#include "bench/bench.h"
 #include <cstring>
 #include <cmath>
 
@@ -11,15 +14,26 @@
 #define USE_SAMPLE_MAP          1
 #define USE_2D_MAP_RENDER       1
 #define MAP_RENDER_SCALE        1
+#define MAP_RENDER_SIZE         (MAP_SIZE * MAP_RENDER_SCALE)
+#define FOV_DIVISOR             8 // Field of view is 1/8 of a full turn
+#define TRIG_TABLE_SIZE         (FOV_DIVISOR * SCREEN_SIZE) // One entry per column angle
+#define USE_ADAPTIVE_RESOLUTION 1
+#define TARGET_FPS              30
+#define DRAW_BUDGET_US          (1000000 / TARGET_FPS)
+#define MAX_COLUMN_STEP         4
+#define COLUMN_STEP_HOLD_FRAMES 15
+#define COLUMN_STEP_DOWN_MARGIN 80
+#define USE_RAY_CACHE           1
+#define RAY_CACHE_SIZE          256 // Power of 2, at least screen width
 
 using namespace picosystem;
 
 struct Player {
-  Vec2<double> position       = {0, 0};
-  Vec2<double> velocity       = {0, 0};
-  float        angle          = 0.0f;
-  float        rotation_speed = 0.2f;
-  float        movement_speed = 0.2f;
+  Vec2<fixed_t> position       = {0, 0};
+  Vec2<fixed_t> velocity       = {0, 0};
+  float         angle          = 0.0f;
+  float         rotation_speed = 0.2f;
+  fixed_t       movement_speed = fixed_t(0.2f);
 };
 
 template <int32_t N>
@@ -80,11 +94,71 @@ enum Side {
   NORTH, SOUTH, WEST, EAST, TOP, BOTTOM
 };
 
+#define SHADED_SIDES 4 // NORTH, SOUTH, WEST, EAST
+
+// Wall colour lookup by side and wall height. Wall height is inversely
+// proportional to distance, so it doubles as a distance index. Per-column
+// shading then costs a single table read.
+struct Shading {
+  struct Color {
+    uint8_t r, g, b;
+  };
+
+  Color   near_color = {0xF, 0xF, 0xF};
+  Color   far_color  = {0x1, 0x1, 0x1};
+  Color   fog_color  = {0x0, 0x0, 0x0};
+  float   fog_start  = 6.0f;  // Distance in tiles where fog starts
+  float   fog_end    = 12.0f; // Distance in tiles where fog fully covers walls
+  uint8_t side_shade[SHADED_SIDES] = {100, 100, 70, 70}; // Brightness in percent
+
+  uint8_t intensity[SCREEN_SIZE + 1]; // 0..0xFF, by wall height
+  uint8_t fog[SCREEN_SIZE + 1];       // 0..0xFF, by wall height
+  Color   ramp[SHADED_SIDES][0x10];   // By side and intensity level
+  color_t lut[SHADED_SIDES][SCREEN_SIZE + 1];
+
+  void build(int32_t screen_height) {
+    for (int32_t h = 0; h <= screen_height; ++h) {
+      float distance = h ? 2.0f * screen_height / h : fog_end;
+      intensity[h] = h * 0xFF / screen_height;
+      fog[h] = cap<float>((distance - fog_start) / (fog_end - fog_start), 0, 1) * 0xFF;
+    }
+
+    for (int32_t side = 0; side < SHADED_SIDES; ++side) {
+      for (int32_t level = 0; level < 0x10; ++level) {
+        ramp[side][level] = {
+          (uint8_t) (mix(far_color.r, near_color.r, level * 0x11) * side_shade[side] / 100),
+          (uint8_t) (mix(far_color.g, near_color.g, level * 0x11) * side_shade[side] / 100),
+          (uint8_t) (mix(far_color.b, near_color.b, level * 0x11) * side_shade[side] / 100)
+        };
+      }
+
+      for (int32_t h = 0; h <= screen_height; ++h) {
+        Color color = ramp[side][intensity[h] >> 4];
+        lut[side][h] = rgb(
+          mix(color.r, fog_color.r, fog[h]),
+          mix(color.g, fog_color.g, fog[h]),
+          mix(color.b, fog_color.b, fog[h])
+        );
+      }
+    }
+  }
+
+  color_t get(Side side, int32_t wall_height) const {
+    return lut[side < SHADED_SIDES ? side : NORTH][wall_height];
+  }
+
+private:
+  // Linear blend from a to b, t in 0..0xFF
+  static uint8_t mix(uint8_t a, uint8_t b, uint32_t t) {
+    return (a * (0xFF - t) + b * t + 0x7F) / 0xFF;
+  }
+};
+
 struct TileHit {
   Vec2<int>     tile_position = {0, 0};
-  Vec2<double>  hit_position  = {0, 0};
-  float         ray_length    = 0.0f;
-  float         sample_x      = 0.0f;
+  Vec2<fixed_t> hit_position  = {0, 0};
+  fixed_t       ray_length    = 0;
+  fixed_t       sample_x      = 0;
   Side          side          = NORTH;
 };
 
@@ -94,20 +168,138 @@ struct DDAResult {
   TileHit tile;
 };
 
+struct CachedRay {
+  int32_t   angle_index = 0;
+  uint32_t  generation  = 0;
+  bool      hit_wall    = false;
+  Side      side        = NORTH;
+  fixed_t   distance    = 0; // Euclidean, without fisheye correction
+  fixed_t   sample_x    = 0;
+};
+
+// Ray results keyed by angle index (multiple of the angle between screen columns),
+// valid while the rays are cast from the same position. Rotating the view only
+// shifts the set of indices, so columns still in view are found again.
+template <int32_t N>
+struct RayCache {
+  static_assert((N & (N - 1)) == 0, "RayCache size must be a power of 2");
+
+  CachedRay    rays[N];
+  Vec2<fixed_t> position  = {0, 0};
+  uint32_t     generation = 1;
+  uint32_t     hits       = 0;
+  uint32_t     lookups    = 0;
+
+  int32_t size() const {
+    return N;
+  }
+
+  void begin_frame(Vec2<fixed_t> position) {
+    if (position != this->position) {
+      this->position = position;
+      generation++;
+    }
+
+    hits = 0;
+    lookups = 0;
+  }
+
+  const CachedRay * get(int32_t angle_index) {
+    CachedRay & ray = rays[angle_index & (N - 1)];
+
+    lookups++;
+    if (ray.generation == generation && ray.angle_index == angle_index) {
+      hits++;
+      return &ray;
+    }
+
+    return nullptr;
+  }
+
+  CachedRay & put(int32_t angle_index) {
+    CachedRay & ray = rays[angle_index & (N - 1)];
+
+    ray.angle_index = angle_index;
+    ray.generation = generation;
+
+    return ray;
+  }
+
+  uint32_t hit_rate() const {
+    return lookups ? hits * 100 / lookups : 0;
+  }
+};
+
 struct Raycaster : App {
   Player player;
   Map<MAP_SIZE> map;
+  RayCache<RAY_CACHE_SIZE> ray_cache;
+  Shading shading;
 
-  float mFov   = 3.14159f / 4.0f;
+  fixed_t sin_table[TRIG_TABLE_SIZE];     // By angle index
+  fixed_t fisheye_table[SCREEN_SIZE + 1]; // Cosine of ray angle relative to view, by column
+
+  buffer_t minimap;
+  color_t minimap_data[MAP_RENDER_SIZE * MAP_RENDER_SIZE];
+
+  // Minimap is mostly transparent, as a sprite only its walls are copied
+  Sprite minimap_sprite;
+  uint16_t minimap_rows[MAP_RENDER_SIZE];
+  uint16_t minimap_runs[SPRITE_MAX_SIZE(MAP_RENDER_SIZE, MAP_RENDER_SIZE)];
+
+  float mFov   = 2.0f * M_PI / FOV_DIVISOR;
   float mDepth = 30.0f;
   float mStep  = 0.01f;
 
+  struct {
+    bool     adaptive = USE_ADAPTIVE_RESOLUTION;
+    int32_t  step     = 1; // Screen columns per ray
+    uint32_t draw_us  = 0; // Running average of draw time
+    uint32_t hold     = 0; // Frames left until step can change again
+  } resolution;
+
+  void prepare() {
+    float column_angle = mFov / SCREEN->w;
+
+    for (int32_t i = 0; i < TRIG_TABLE_SIZE; ++i) {
+      sin_table[i] = fixed_t(sinf(i * column_angle));
+    }
+
+    for (int32_t x = 0; x <= SCREEN->w; ++x) {
+      fisheye_table[x] = fixed_t(cosf((x - SCREEN->w / 2) * column_angle));
+    }
+
+    shading.build(SCREEN->h);
+
+#if USE_2D_MAP_RENDER
+    // Walls on transparent background, drawn over the 3D view
+    buffer_init(&minimap, MAP_RENDER_SIZE, MAP_RENDER_SIZE, minimap_data);
+    memset(minimap_data, 0, sizeof(minimap_data));
+
+    target(&minimap);
+    pen(0x8, 0x8, 0xF);
+    for (int32_t y = 0; y < map.size(); ++y) {
+      for (int32_t x = 0; x < map.size(); ++x) {
+        if (map.get(x, y).type == TILE_WALL) {
+          rect(x * MAP_RENDER_SCALE, y * MAP_RENDER_SCALE, MAP_RENDER_SCALE, MAP_RENDER_SCALE);
+        }
+      }
+    }
+    target();
+
+    sprite_encode(&minimap, minimap_rows, minimap_runs, sizeof(minimap_runs) / sizeof(minimap_runs[0]), minimap_sprite);
+#endif
+  }
+
   void init() {
-    player.position.x = map.size() / 2;
-    player.position.y = map.size() / 2;
+    player.position = {map.size() / 2, map.size() / 2};
   }
 
   void update(uint32_t tick) {
+    if (pressed(A)) {
+      resolution.adaptive = !resolution.adaptive;
+    }
+
     if (button(LEFT)) {
       player.angle -= player.rotation_speed; //* frameTime;
       if (player.angle < -2.0f * M_PI) { // kinda works?
@@ -122,200 +314,213 @@ struct Raycaster : App {
       }
     }
 
-    if (button(UP)) {
-      player.position.x += sinf(player.angle) * player.movement_speed; //* frameTime;
-      player.position.y += cosf(player.angle) * player.movement_speed; //* frameTime;
-
-      if (map.get((int) player.position.x, (int) player.position.y).type == TILE_WALL) {
-        player.position.x -= sinf(player.angle) * player.movement_speed; //* frameTime;
-        player.position.y -= cosf(player.angle) * player.movement_speed; //* frameTime;
+    if (button(UP) || button(DOWN)) {
+      Vec2<fixed_t> step = direction(player.angle) * player.movement_speed; //* frameTime;
+      if (button(DOWN)) {
+        step = -step;
       }
-    }
 
-    if (button(DOWN)) {
-      player.position.x -= sinf(player.angle) * player.movement_speed; //* frameTime;
-      player.position.y -= cosf(player.angle) * player.movement_speed; //* frameTime;
+      player.position += step;
 
-      if (map.get((int) player.position.x, (int) player.position.y).type == TILE_WALL) {
-        player.position.x += sinf(player.angle) * player.movement_speed; //* frameTime;
-        player.position.y += cosf(player.angle) * player.movement_speed; //* frameTime;
+      if (map.get(player.position.x.to_int(), player.position.y.to_int()).type == TILE_WALL) {
+        player.position -= step;
+        audio.play(Sound::tone(NOISE, 1500, 30, 0x80));
       }
     }
   }
 
   void draw(uint32_t tick) {
+    uint32_t draw_start = time_us();
     auto screen_height = SCREEN->h;
     auto screen_width = SCREEN->w;
+    int32_t step = resolution.step;
 
-    for (int x = 0; x < screen_width; x++) {
-      float ray_angle = (player.angle - mFov/2.0f) + (x / (float)screen_width) * mFov;
-      Vec2<double> ray_direction = {sinf(ray_angle), cosf(ray_angle)};
+    // View angle is snapped to the column angle grid, so rays of a rotated view
+    // land on the same angle indices as before
+    float column_angle = mFov / screen_width;
+    int32_t view_index = floorf(player.angle / column_angle + 0.5f);
 
-      DDAResult result = cast_ray(player.position, ray_direction);
+    ray_cache.begin_frame(player.position);
 
-      if (result.hit_wall) {
-        Vec2<double> ray = {
-          result.tile.hit_position.x - player.position.x,
-          result.tile.hit_position.y - player.position.y
-        };
+    for (int x = 0; x < screen_width; x += step) {
+      int32_t width = std::min<int32_t>(step, screen_width - x);
+      int32_t column = x + width / 2;
+      int32_t angle_index = view_index - screen_width / 2 + column;
 
-        float ray_length = sqrt(ray.x * ray.x + ray.y * ray.y) * cos(ray_angle - player.angle);
+      const CachedRay & ray = trace(angle_index);
 
-        float ceiling = (screen_height / 2.0f) - screen_height / ray_length;
-        float floor = screen_height - ceiling;
-        float wall_height = cap<float>(floor - ceiling, 0, screen_height);
+      if (ray.hit_wall) {
+        fixed_t ray_length = ray.distance * fisheye_table[column];
+
+        // Wall spans 2 * screen_height / ray_length, so at 2 tiles or closer it fills the screen
+        int32_t wall_height = ray_length > 2 ? (fixed_t(2 * screen_height) / ray_length).to_int() : screen_height;
+        int32_t ceiling = (screen_height - wall_height) / 2;
 
 #if 0
-        float whole;
-        int texture_x = std::modf(result.tile.sampleX, &whole) * texture->getWidth();
+        int texture_x = (ray.sample_x * texture->getWidth()).to_int();
 #endif
 
-        int32_t color = scale(
-          wall_height,
-          {0, (float) screen_height},
-          {1, 0xF}
-        );
-
-        pen(color, color, color, 0xF);
-        vline(x, cap<float>(ceiling, 1, screen_height), wall_height);
+        pen(shading.get(ray.side, wall_height));
+        if (width == 1) {
+          vline(x, cap<int32_t>(ceiling, 1, screen_height), wall_height);
+        } else {
+          frect(x, cap<int32_t>(ceiling, 1, screen_height), width, wall_height);
+        }
       }
     }
 
 #if USE_2D_MAP_RENDER
-    pen(0x8, 0x8, 0xF);
-    for (int32_t y = 0; y < map.size(); ++y) {
-      for (int32_t x = 0; x < map.size(); ++x) {
-        if (map.get(x, y).type == TILE_WALL) {
-          rect(x * MAP_RENDER_SCALE, y * MAP_RENDER_SCALE, MAP_RENDER_SCALE, MAP_RENDER_SCALE);
-        }
-      }
-    }
+    sprite_blit(SCREEN, minimap_sprite, 0, 0);
 
     pen(0xF, 0, 0);
-    pixel(player.position.x, player.position.y);
+    pixel(player.position.x.to_int(), player.position.y.to_int());
 #endif
+
+    update_resolution(time_us() - draw_start);
+  }
+
+  // Rays from the map centre, spread over the full circle of angle indices
+  void bench(Bench & bench) {
+    bench.add("cast_ray", 2000, [](void * ctx, uint32_t i) -> uint32_t {
+      Raycaster * self = (Raycaster *) ctx;
+      Vec2<fixed_t> centre = {MAP_SIZE / 2, MAP_SIZE / 2};
+      return self->cast_ray(centre, self->ray_direction(i * 97 % TRIG_TABLE_SIZE)).tile.ray_length.raw;
+    }, this);
+  }
+
+  void draw_info() {
+    auto step_str = "x" + std::to_string(resolution.step) + (resolution.adaptive ? "A" : "")
+      + " " + std::to_string(ray_cache.hit_rate()) + "%";
+    int32_t x, y;
+    measure(step_str, x, y);
+
+    pen(0xF, 0xF, 0xF);
+    text(step_str, (SCREEN->w - x) / 2, SCREEN->h - y - 1);
   }
 
 private:
-  DDAResult cast_ray(Vec2<double> src, Vec2<double> direction) {
+  const CachedRay & trace(int32_t angle_index) {
+#if USE_RAY_CACHE
+    if (const CachedRay * cached = ray_cache.get(angle_index)) {
+      return *cached;
+    }
+#endif
+
+    DDAResult result = cast_ray(player.position, ray_direction(angle_index));
+    CachedRay & ray = ray_cache.put(angle_index);
+
+    ray.hit_wall = result.hit_wall;
+    ray.side = result.tile.side;
+    ray.sample_x = result.tile.sample_x;
+    ray.distance = result.tile.ray_length;
+
+    return ray;
+  }
+
+  static Vec2<fixed_t> direction(float angle) {
+    return {fixed_t(sinf(angle)), fixed_t(cosf(angle))};
+  }
+
+  // Direction of ray with given angle index, cosine is sine a quarter turn ahead
+  Vec2<fixed_t> ray_direction(int32_t angle_index) const {
+    int32_t i = angle_index % TRIG_TABLE_SIZE;
+    if (i < 0) {
+      i += TRIG_TABLE_SIZE;
+    }
+
+    return {sin_table[i], sin_table[(i + TRIG_TABLE_SIZE / 4) % TRIG_TABLE_SIZE]};
+  }
+
+  // Picks columns per ray to keep draw time within budget. Step only coarsens when
+  // over budget, and refines when twice the current time would still fit with margin,
+  // holding each change for a while so it doesn't flicker between two steps
+  void update_resolution(uint32_t draw_us) {
+    resolution.draw_us = (resolution.draw_us * 7 + draw_us) / 8;
+
+    if (!resolution.adaptive) {
+      resolution.step = 1;
+      return;
+    }
+
+    if (resolution.hold) {
+      resolution.hold--;
+      return;
+    }
+
+    if (resolution.draw_us > DRAW_BUDGET_US && resolution.step < MAX_COLUMN_STEP) {
+      resolution.step *= 2;
+      resolution.hold = COLUMN_STEP_HOLD_FRAMES;
+    } else if (resolution.step > 1 && resolution.draw_us * 2 * 100 < DRAW_BUDGET_US * COLUMN_STEP_DOWN_MARGIN) {
+      resolution.step /= 2;
+      resolution.hold = COLUMN_STEP_HOLD_FRAMES;
+    }
+  }
+
+  // Steps through the grid one tile boundary at a time (DDA). Direction is a unit
+  // vector, so the side distances are also the distance travelled along the ray
+  DDAResult HOT_FUNC(cast_ray)(Vec2<fixed_t> src, Vec2<fixed_t> direction) {
     DDAResult result;
 
-    Vec2<double> ray_delta = {
-      sqrt(1 + (direction.y / direction.x) * (direction.y / direction.x)),
-      sqrt(1 + (direction.x / direction.y) * (direction.x / direction.y))
-    };
+    // Distance along the ray between two vertical (x) or horizontal (y) grid lines
+    Vec2<fixed_t> ray_delta = {abs(reciprocal(direction.x)), abs(reciprocal(direction.y))};
 
-    Vec2<int> map_check = {(int)src.x, (int)src.y};
-    Vec2<double> side_distance, step_distance;
+    Vec2<int> map_check = {src.x.to_int(), src.y.to_int()};
+    Vec2<int> step;
+    Vec2<fixed_t> side_distance;
 
     if (direction.x < 0) {
-      step_distance.x = -1;
-      side_distance.x = (src.x - (float)map_check.x) * ray_delta.x;
+      step.x = -1;
+      side_distance.x = src.x.fract() * ray_delta.x;
     } else {
-      step_distance.x = 1;
-      side_distance.x = ((float)map_check.x + 1 - src.x) * ray_delta.x;
+      step.x = 1;
+      side_distance.x = (1 - src.x.fract()) * ray_delta.x;
     }
 
     if (direction.y < 0) {
-      step_distance.y = -1;
-      side_distance.y = (src.y - (float)map_check.y) * ray_delta.y;
+      step.y = -1;
+      side_distance.y = src.y.fract() * ray_delta.y;
     } else {
-      step_distance.y = 1;
-      side_distance.y = ((float)map_check.y + 1 - src.y) * ray_delta.y;
+      step.y = 1;
+      side_distance.y = (1 - src.y.fract()) * ray_delta.y;
     }
 
-    Vec2<double> intersection;
-    Vec2<int> hit_tile;
-    float max_distance  = 100.0f;
-    float distance      = 0.0f;
-    TileHit hit;
+    fixed_t max_distance = 100;
+    fixed_t distance     = 0;
+    bool    x_side       = false;
 
     while (!result.hit_wall && distance < max_distance) {
       if (side_distance.x < side_distance.y) {
+        distance = side_distance.x;
         side_distance.x += ray_delta.x;
-        map_check.x += step_distance.x;
+        map_check.x += step.x;
+        x_side = true;
       } else {
+        distance = side_distance.y;
         side_distance.y += ray_delta.y;
-        map_check.y += step_distance.y;
+        map_check.y += step.y;
+        x_side = false;
       }
 
-      Vec2<double> ray_distance = {(float)map_check.x - src.x, (float)map_check.y - src.y};
-      distance = sqrt(ray_distance.x * ray_distance.x + ray_distance.y * ray_distance.y);
+      if (map_check.x < 0 || map_check.y < 0 || map_check.x >= map.size() || map_check.y >= map.size()) {
+        break;
+      }
 
       if (map.get(map_check).type == TILE_WALL) {
-        hit_tile = map_check;
+        TileHit & hit = result.tile;
 
         result.hit_wall = true;
 
         hit.tile_position = map_check;
+        hit.hit_position = src + direction * distance;
+        hit.ray_length = distance;
 
-        float m = direction.y / direction.x;
-
-        if (src.y <= map_check.y) {
-          if (src.x <= map_check.x) {
-            hit.side = WEST;
-            intersection.y = m * (map_check.x - src.x) + src.y;
-            intersection.x = float(map_check.x);
-            hit.sample_x = intersection.y - std::floor(intersection.y);
-          } else if (src.x >= (map_check.x + 1)) {
-            hit.side = EAST;
-            intersection.y = m * ((map_check.x + 1) - src.x) + src.y;
-            intersection.x = float(map_check.x + 1);
-            hit.sample_x = intersection.y - std::floor(intersection.y);
-          } else {
-            hit.side = NORTH;
-            intersection.y = float(map_check.y);
-            intersection.x = (map_check.y - src.y) / m + src.x;
-            hit.sample_x = intersection.x - std::floor(intersection.x);
-          }
-
-          if (intersection.y < map_check.y) {
-            hit.side = NORTH;
-            intersection.y = float(map_check.y);
-            intersection.x = (map_check.y - src.y) / m + src.x;
-            hit.sample_x = intersection.x - std::floor(intersection.x);
-          }
-        } else if (src.y >= map_check.y + 1) {
-          if (src.x <= map_check.x) {
-            hit.side = WEST;
-            intersection.y = m * (map_check.x - src.x) + src.y;
-            intersection.x = float(map_check.x);
-            hit.sample_x = intersection.y - std::floor(intersection.y);
-          } else if (src.x >= (map_check.x + 1)) {
-            hit.side = EAST;
-            intersection.y = m * ((map_check.x + 1) - src.x) + src.y;
-            intersection.x = float(map_check.x + 1);
-            hit.sample_x = intersection.y - std::floor(intersection.y);
-          } else {
-            hit.side = SOUTH;
-            intersection.y = float(map_check.y + 1);
-            intersection.x = ((map_check.y + 1) - src.y) / m + src.x;
-            hit.sample_x = intersection.x - std::floor(intersection.x);
-          }
-
-          if (intersection.y > (map_check.y + 1)) {
-            hit.side = SOUTH;
-            intersection.y = float(map_check.y + 1);
-            intersection.x = ((map_check.y + 1) - src.y) / m + src.x;
-            hit.sample_x = intersection.x - std::floor(intersection.x);
-          }
+        if (x_side) {
+          hit.side = step.x > 0 ? WEST : EAST;
+          hit.sample_x = hit.hit_position.y.fract();
         } else {
-          if (src.x <= map_check.x) {
-            hit.side = WEST;
-            intersection.y = m * (map_check.x - src.x) + src.y;
-            intersection.x = float(map_check.x);
-            hit.sample_x = intersection.y - std::floor(intersection.y);
-          } else if (src.x >= (map_check.x + 1)) {
-            hit.side = EAST;
-            intersection.y = m * ((map_check.x + 1) - src.x) + src.y;
-            intersection.x = float(map_check.x + 1);
-            hit.sample_x = intersection.y - std::floor(intersection.y);
-          }
+          hit.side = step.y > 0 ? NORTH : SOUTH;
+          hit.sample_x = hit.hit_position.x.fract();
         }
-
-        hit.hit_position = intersection;
-
-        result.tile = hit;
       }
     }
 
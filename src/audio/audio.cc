@@ -0,0 +1,118 @@
+#include "audio/audio.h"
+#include "picosystem.hpp"
+#include "pico/multicore.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/pio.h"
+#include "audio.pio.h"
+
+#define AUDIO_PIO pio1 // Away from pio0, which the picosystem library may use for the screen
+
+using namespace picosystem;
+
+Audio audio;
+
+static void audio_core1_main() {
+  // Lets flash writes on core 0 pause this core while XIP is unavailable
+  multicore_lockout_victim_init();
+  audio.run();
+}
+
+void Audio::init() {
+  if (running) {
+    return;
+  }
+
+  stats = {0, 0};
+  queue_init(&queue, sizeof(Sound), AUDIO_QUEUE_SIZE);
+
+  // The picosystem library plays its own notes through the PWM slice of this pin and
+  // reprograms the slice from a repeating timer of its own, which its API has no way to
+  // stop. So the speaker is driven from PIO instead, and the pin is switched over to it,
+  // which cuts the slice off: whatever the library writes there doesn't reach the speaker.
+  pio_sm = pio_claim_unused_sm(AUDIO_PIO, true);
+  uint32_t offset = pio_add_program(AUDIO_PIO, &audio_pwm_program);
+  pio_sm_config sm_config = audio_pwm_program_get_default_config(offset);
+  sm_config_set_sideset_pins(&sm_config, AUDIO_PIN);
+  pio_sm_set_consecutive_pindirs(AUDIO_PIO, pio_sm, AUDIO_PIN, 1, true);
+  pio_sm_init(AUDIO_PIO, pio_sm, offset, &sm_config);
+  claim_pin();
+
+  // Period goes into ISR through OSR, then the first level is queued
+  pio_sm_put_blocking(AUDIO_PIO, pio_sm, (1 << AUDIO_PWM_BITS) - 1);
+  pio_sm_exec(AUDIO_PIO, pio_sm, pio_encode_pull(false, false));
+  pio_sm_exec(AUDIO_PIO, pio_sm, pio_encode_out(pio_isr, 32));
+  pio_sm_put_blocking(AUDIO_PIO, pio_sm, 1 << (AUDIO_PWM_BITS - 1));
+  pio_sm_set_enabled(AUDIO_PIO, pio_sm, true);
+
+  dma_timer = dma_claim_unused_timer(true);
+  sync_clock();
+
+  // Paced by the timer, not by the FIFO: the state machine takes a level per period, which is faster
+  dma_channel = dma_claim_unused_channel(true);
+  dma_channel_config dma_config = dma_channel_get_default_config(dma_channel);
+  channel_config_set_transfer_data_size(&dma_config, DMA_SIZE_32);
+  channel_config_set_read_increment(&dma_config, true);
+  channel_config_set_write_increment(&dma_config, false);
+  channel_config_set_dreq(&dma_config, dma_get_timer_dreq(dma_timer));
+  dma_channel_configure(dma_channel, &dma_config, &AUDIO_PIO->txf[pio_sm], blocks[0], AUDIO_BLOCK_SIZE, false);
+
+  for (auto & block : blocks) {
+    for (auto & level : block) {
+      level = 1 << (AUDIO_PWM_BITS - 1);
+    }
+  }
+
+  running = true;
+  multicore_launch_core1(audio_core1_main);
+}
+
+// Pin is taken back on every block, should the library ever switch it to PWM again
+void Audio::claim_pin() {
+  if (gpio_get_function(AUDIO_PIN) != GPIO_FUNC_PIO1) {
+    pio_gpio_init(AUDIO_PIO, AUDIO_PIN);
+  }
+}
+
+void Audio::sync_clock() {
+  // DMA timer ticks at clk_sys / divider, which approximates the sample rate
+  dma_timer_set_fraction(dma_timer, 1, clock_get_hz(clk_sys) / AUDIO_SAMPLE_RATE);
+}
+
+bool Audio::play(const Sound & sound) {
+  return running && queue_try_add(&queue, &sound);
+}
+
+uint32_t Audio::voice_us() const {
+  return stats.voices ? stats.mix_us / stats.voices : 0;
+}
+
+void Audio::run() {
+  uint32_t next = 0;
+
+  dma_channel_set_read_addr(dma_channel, blocks[1], true);
+
+  while (true) {
+    Sound sound;
+    while (queue_try_remove(&queue, &sound)) {
+      mixer.play(sound);
+    }
+
+    uint32_t start = time_us_32();
+    uint32_t voices = mixer.active();
+
+    mixer.render(pcm, AUDIO_BLOCK_SIZE);
+    for (uint32_t i = 0; i < AUDIO_BLOCK_SIZE; ++i) {
+      blocks[next][i] = (pcm[i] + 0x8000) >> (16 - AUDIO_PWM_BITS);
+    }
+
+    stats.mix_us = time_us_32() - start;
+    stats.voices = voices;
+
+    claim_pin();
+
+    dma_channel_wait_for_finish_blocking(dma_channel);
+    dma_channel_set_read_addr(dma_channel, blocks[next], true);
+    next ^= 1;
+  }
+}
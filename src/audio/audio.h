@@ -0,0 +1,48 @@
+#pragma once
+
+#include "audio/mixer.h"
+#include "pico/util/queue.h"
+#include <cstdint>
+
+#define AUDIO_BLOCK_SIZE    256 // Samples per PCM block, two blocks are double-buffered
+#define AUDIO_QUEUE_SIZE    8
+#define AUDIO_PWM_BITS      9  // Carrier is clk_sys / 3 / 2^bits, above 30 kHz at idle clock
+#define AUDIO_PIN           11
+
+// Audio engine running on core 1. Mixer fills one PCM block while DMA streams
+// the other one to the speaker PWM on PIO, paced by a DMA timer at the sample rate.
+// Other code only pushes sounds onto a queue, so playing a sound never blocks.
+struct Audio {
+  struct Stats {
+    uint32_t mix_us;  // Time to mix last block
+    uint32_t voices;  // Voices active in last block
+  } stats;
+
+  Mixer mixer;
+  queue_t queue;
+
+  uint32_t blocks[2][AUDIO_BLOCK_SIZE]; // PWM levels, one FIFO word each
+  int16_t  pcm[AUDIO_BLOCK_SIZE];
+  int32_t  dma_channel;
+  int32_t  dma_timer;
+  int32_t  pio_sm;
+  bool     running;
+
+  void init();
+
+  // Keeps sample rate after clk_sys changes
+  void sync_clock();
+
+  // Returns false if queue is full and the sound was dropped
+  bool play(const Sound & sound);
+
+  // Routes the speaker pin to the PIO state machine, unless it already is
+  void claim_pin();
+
+  // Mixing time per active voice for one block, in us
+  uint32_t voice_us() const;
+
+  void run();
+};
+
+extern Audio audio;
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "util/hot.h"
+#include <cstddef>
+#include <cstdint>
+
+#define AUDIO_SAMPLE_RATE   22050
+#define AUDIO_VOICES        4
+#define AUDIO_LEVEL_BITS    24 // Envelope level resolution
+
+#define AUDIO_MS_TO_SAMPLES(__ms) ((uint32_t) (__ms) * AUDIO_SAMPLE_RATE / 1000)
+
+enum Waveform : uint8_t {
+  SQUARE, NOISE, SAMPLE
+};
+
+struct Sound {
+  Waveform       waveform      = SQUARE;
+  uint16_t       frequency     = 440;  // Hz, for SQUARE and NOISE
+  uint16_t       duration      = 100;  // ms, until release starts
+  uint8_t        volume        = 0xFF;
+  uint16_t       attack        = 2;    // ms
+  uint16_t       decay         = 20;   // ms
+  uint8_t        sustain       = 0xB0; // Level held after decay
+  uint16_t       release       = 40;   // ms
+  const int8_t * sample        = nullptr; // Signed 8-bit PCM at AUDIO_SAMPLE_RATE, for SAMPLE
+  uint32_t       sample_length = 0;
+
+  static Sound tone(Waveform waveform, uint16_t frequency, uint16_t duration, uint8_t volume = 0xFF) {
+    Sound sound;
+    sound.waveform = waveform;
+    sound.frequency = frequency;
+    sound.duration = duration;
+    sound.volume = volume;
+    return sound;
+  }
+};
+
+struct Voice {
+  enum Stage : uint8_t {
+    OFF, ATTACK, DECAY, SUSTAIN, RELEASE
+  };
+
+  Sound    sound;
+  Stage    stage        = OFF;
+  uint32_t phase        = 0; // Fraction of a period in 1/2^32, or sample position in 1/2^16 for SAMPLE
+  uint32_t phase_step   = 0;
+  uint32_t noise        = 1; // LFSR state
+  int32_t  level        = 0; // 0..1 << AUDIO_LEVEL_BITS
+  int32_t  level_step   = 0;
+  uint32_t stage_length = 0; // Samples left in current stage
+
+  void start(const Sound & sound) {
+    this->sound = sound;
+    phase = 0;
+    phase_step = sound.waveform == SAMPLE ? 1 << 16 : (uint32_t) (((uint64_t) sound.frequency << 32) / AUDIO_SAMPLE_RATE);
+    level = 0;
+    enter(ATTACK);
+  }
+
+  // Next sample, scaled by envelope and volume to about +-(1 << 15)
+  int32_t next() {
+    int32_t wave;
+
+    switch (sound.waveform) {
+      case SQUARE:
+        wave = phase < 0x80000000 ? 127 : -127;
+        phase += phase_step;
+        break;
+      case NOISE:
+        if (phase + phase_step < phase) {
+          noise = (noise >> 1) ^ (-(noise & 1) & 0xB400);
+        }
+        phase += phase_step;
+        wave = noise & 1 ? 127 : -127;
+        break;
+      case SAMPLE:
+      default:
+        if ((phase >> 16) >= sound.sample_length) {
+          stage = OFF;
+          return 0;
+        }
+        wave = sound.sample[phase >> 16];
+        phase += phase_step;
+        break;
+    }
+
+    int32_t sample = wave * (level >> (AUDIO_LEVEL_BITS - 8)) * sound.volume >> 8;
+
+    level += level_step;
+    if (--stage_length == 0) {
+      enter((Stage) (stage + 1));
+    }
+
+    return sample;
+  }
+
+private:
+  void enter(Stage next) {
+    stage = next;
+
+    switch (stage) {
+      case ATTACK:
+        stage_length = AUDIO_MS_TO_SAMPLES(sound.attack) + 1;
+        level_step = ((1 << AUDIO_LEVEL_BITS) - level) / (int32_t) stage_length;
+        break;
+      case DECAY:
+        stage_length = AUDIO_MS_TO_SAMPLES(sound.decay) + 1;
+        level_step = (sustain_level() - level) / (int32_t) stage_length;
+        break;
+      case SUSTAIN: {
+        uint32_t elapsed = AUDIO_MS_TO_SAMPLES(sound.attack + sound.decay);
+        uint32_t length = AUDIO_MS_TO_SAMPLES(sound.duration);
+        stage_length = length > elapsed ? length - elapsed : 1;
+        level = sustain_level();
+        level_step = 0;
+        break;
+      }
+      case RELEASE:
+        stage_length = AUDIO_MS_TO_SAMPLES(sound.release) + 1;
+        level_step = -level / (int32_t) stage_length;
+        break;
+      case OFF:
+      default:
+        stage = OFF;
+        level = 0;
+        level_step = 0;
+        break;
+    }
+  }
+
+  int32_t sustain_level() const {
+    return sound.sustain << (AUDIO_LEVEL_BITS - 8);
+  }
+};
+
+struct Mixer {
+  Voice voices[AUDIO_VOICES];
+
+  // Starts the sound on a free voice, or steals the quietest one
+  void play(const Sound & sound) {
+    Voice * target = &voices[0];
+
+    for (auto & voice : voices) {
+      if (voice.stage == Voice::OFF) {
+        target = &voice;
+        break;
+      }
+
+      if (voice.level < target->level) {
+        target = &voice;
+      }
+    }
+
+    target->start(sound);
+  }
+
+  uint32_t active() const {
+    uint32_t count = 0;
+
+    for (auto & voice : voices) {
+      count += voice.stage != Voice::OFF;
+    }
+
+    return count;
+  }
+
+  // Mixes count samples of signed 16-bit PCM
+  void HOT_FUNC(render)(int16_t * out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = 0;
+    }
+
+    for (auto & voice : voices) {
+      for (size_t i = 0; i < count && voice.stage != Voice::OFF; ++i) {
+        int32_t sample = out[i] + (voice.next() >> 1);
+        out[i] = sample > INT16_MAX ? INT16_MAX : sample < INT16_MIN ? INT16_MIN : sample;
+      }
+    }
+  }
+};
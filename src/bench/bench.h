@@ -0,0 +1,50 @@
+#pragma once
+
+#include "picosystem.hpp"
+#include "util/stack.h"
+#include <cstdint>
+
+#define BENCH_MAX_KERNELS   16
+#define BENCH_WARMUP        16 // Untimed iterations before each kernel, to warm up caches
+
+// Suite of timed kernels. Each kernel runs a fixed number of iterations, with
+// i passed in so that it can vary its input. Kernels return some of their output,
+// which is folded into sink so the compiler can't drop the work. Apps add their own kernels through
+// App::bench(), which keeps the code under test private to the app.
+struct Bench {
+  struct Kernel {
+    const char * name;
+    uint32_t     iterations;
+    uint32_t   (*run)(void * ctx, uint32_t i);
+    void *       ctx;
+    uint32_t     total_us; // Time of all timed iterations, 0 until run
+  };
+
+  Stack<Kernel, BENCH_MAX_KERNELS> kernels;
+
+  volatile uint32_t sink = 0;
+
+  void clear() {
+    kernels.clear();
+  }
+
+  bool add(const char * name, uint32_t iterations, uint32_t (*run)(void *, uint32_t), void * ctx) {
+    return kernels.push({name, iterations, run, ctx, 0});
+  }
+
+  void run(Kernel & kernel) {
+    for (uint32_t i = 0; i < BENCH_WARMUP; ++i) {
+      sink = sink + kernel.run(kernel.ctx, i);
+    }
+
+    uint32_t start = picosystem::time_us();
+    for (uint32_t i = 0; i < kernel.iterations; ++i) {
+      sink = sink + kernel.run(kernel.ctx, i);
+    }
+    kernel.total_us = picosystem::time_us() - start;
+  }
+
+  static uint32_t ns_per_iteration(const Kernel & kernel) {
+    return (uint64_t) kernel.total_us * 1000 / kernel.iterations;
+  }
+};
@@ -1,25 +1,61 @@
 #include "loader/loader.h"
 #include "util/util.h"
+#include "audio/audio.h"
 #include "picosystem.hpp"
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
+#include <cstdio>
 
 #define VERSION     "0.1"
 #define STARTUP_MSG "Loader " VERSION
 
 using namespace picosystem;
 
+#define BUTTON_MASK ((1u << UP) | (1u << DOWN) | (1u << LEFT) | (1u << RIGHT) | (1u << A) | (1u << B) | (1u << X) | (1u << Y))
+
 ApplicationList<MAX_APPS> apps;
 
+// Reads buttons straight from GPIO (active low), as picosystem only samples them once per tick
+static bool any_button() {
+  return (~gpio_get_all() & BUTTON_MASK) != 0;
+}
+
 void Loader::init() {
-  startup_timeout = Timeout(500);
+  boot.init = time_us();
+  stdio_init_all();
+  idle_timeout = Timeout(IDLE_TIMEOUT);
+  full_clock_khz = clock_get_hz(clk_sys) / 1000;
+  audio.init();
 }
 
 void Loader::update(uint32_t tick) {
+  update_power();
+
+  // Startup message is on screen by now, apps are prepared before first menu frame
+  if (!flags.is_init) {
+    if (flags.splash) {
+      prepare_apps();
+    }
+    return;
+  }
+
   if (pressed(UP) && pressed(X)) {
+    if (flags.run_app) {
+      apps.buffer[app_idx].app->exit();
+    }
     flags.run_app = false;
   }
 
   if (flags.run_app) {
+#if USE_XIP_STATS
+    xip.update.begin();
+#endif
     apps.buffer[app_idx].app->update(tick);
+#if USE_XIP_STATS
+    xip.update.end();
+#endif
   } else {
     if (pressed(Y)) {
       flags.draw_info = !flags.draw_info;
@@ -40,15 +76,62 @@ void Loader::update(uint32_t tick) {
   }
 }
 
+// Drops clock and frame rate when nothing animates and there was no input for a while,
+// then waits for input with the core mostly asleep. Input restores full clock right away.
+void Loader::update_power() {
+  bool active = any_button() || !flags.boot_done
+    || (flags.run_app && apps.buffer[app_idx].app->continuous());
+
+  if (active) {
+    idle_timeout.restart();
+    if (flags.idle) {
+      exit_idle();
+    }
+    return;
+  }
+
+  if (!flags.idle && idle_timeout.expired()) {
+    enter_idle();
+  }
+
+  if (flags.idle) {
+    for (uint32_t ms = 0; ms < IDLE_FRAME_MS && !any_button(); ++ms) {
+      sleep_ms(1);
+    }
+
+    if (any_button()) {
+      idle_timeout.restart();
+      exit_idle();
+    }
+  }
+}
+
+void Loader::enter_idle() {
+  flags.idle = true;
+  set_sys_clock_khz(IDLE_CLOCK_KHZ, false);
+  audio.sync_clock();
+}
+
+void Loader::exit_idle() {
+  flags.idle = false;
+  set_sys_clock_khz(full_clock_khz, false);
+  audio.sync_clock();
+}
+
 void Loader::draw(uint32_t tick) {
   pen(0, 0, 0);
   clear();
 
-  if (!startup_timeout.expired()) {
+  if (!flags.is_init) {
     draw_startup_msg();
+    flags.splash = true;
     return;
   }
 
+#if USE_XIP_STATS
+  xip.draw.begin();
+#endif
+
   if (flags.run_app) {
     apps.buffer[app_idx].app->draw(tick);
   } else {
@@ -58,6 +141,39 @@ void Loader::draw(uint32_t tick) {
   if (flags.draw_info) {
     draw_info();
   }
+
+#if USE_XIP_STATS
+  xip.draw.end();
+#endif
+
+  if (!flags.boot_done) {
+    boot.first_frame = time_us();
+    flags.boot_done = true;
+  }
+
+  // Boot is long over by the time a host opens the serial port, so timing is
+  // printed whenever a terminal connects instead of into the void at boot
+  bool usb_open = stdio_usb_connected();
+  if (usb_open && !flags.usb_open) {
+    print_boot();
+  }
+  flags.usb_open = usb_open;
+}
+
+void Loader::print_boot() {
+  printf(
+    "boot: reset->init %lums, init->prepared %lums, prepared->menu %lums\n",
+    boot.init / 1000, (boot.prepared - boot.init) / 1000, (boot.first_frame - boot.prepared) / 1000
+  );
+}
+
+void Loader::prepare_apps() {
+  for (size_t i = 0; i < apps.size; ++i) {
+    apps.buffer[i].app->prepare();
+  }
+
+  boot.prepared = time_us();
+  flags.is_init = true;
 }
 
 void Loader::draw_startup_msg() {
@@ -65,26 +181,24 @@ void Loader::draw_startup_msg() {
 
   measure(STARTUP_MSG, x, y);
 
-  pen(0, 0, 0);
-  clear();
-
   pen(0xF, 0xF, 0xF);
   text(STARTUP_MSG, (SCREEN->w - x) / 2, (SCREEN->h - y) / 2);
 }
 
 void Loader::draw_apps() {
+  int32_t x, y;
+  measure("Apps", x, y);
+
   pen(0, 0, 0xF);
-  text("Apps (press B to run):\n");
+  text("Apps (press B to run):", 0, 0);
 
-  pen(0xF, 0xF, 0xF);
   for (size_t i = 0; i < apps.size; ++i) {
     if (app_idx == i) {
       pen(0x8, 0xF, 0x8);
-    }
-    text(std::string(apps.buffer[i].name) + "\n");
-    if (app_idx == i) {
+    } else {
       pen(0xF, 0xF, 0xF);
     }
+    text(apps.buffer[i].name, 0, (i + 1) * y);
   }
 }
 
@@ -99,4 +213,29 @@ void Loader::draw_info() {
   auto fps_str = std::to_string(stats.fps);
   measure(fps_str, x, y);
   text(fps_str, 1, SCREEN->h - y - 1);
+
+  if (!flags.run_app) {
+    auto boot_str = "boot " + std::to_string(boot.init / 1000) + "+" + std::to_string((boot.prepared - boot.init) / 1000)
+      + "+" + std::to_string((boot.first_frame - boot.prepared) / 1000) + "ms";
+    measure(boot_str, x, y);
+    text(boot_str, (SCREEN->w - x) / 2, SCREEN->h - y - 1);
+  }
+
+  auto audio_str = std::to_string(audio.voice_us()) + "us/v";
+  measure(audio_str, x, y);
+  text(audio_str, SCREEN->w - x - 1, 1);
+
+#if USE_XIP_STATS
+  // XIP cache hit rate of last update and draw, e.g. c97/88%
+  if (flags.run_app) {
+    int32_t line_h = y + 1;
+    auto xip_str = "c" + std::to_string(xip.update.hit_rate()) + "/" + std::to_string(xip.draw.hit_rate()) + "%";
+    measure(xip_str, x, y);
+    text(xip_str, SCREEN->w - x - 1, line_h + 1);
+  }
+#endif
+
+  if (flags.run_app) {
+    apps.buffer[app_idx].app->draw_info();
+  }
 }
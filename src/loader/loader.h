@@ -4,21 +4,49 @@
 #include <cstdint>
 #include <cstddef>
 
-#define MAX_APPS 5
+#define MAX_APPS          8
+#define IDLE_TIMEOUT      3000  // ms without input before Loader goes idle
+#define IDLE_FRAME_MS     100   // Frame period while idle
+#define IDLE_CLOCK_KHZ    48000
+#define USE_XIP_STATS     0     // Measure XIP cache hit rate of app update/draw
 
+#if USE_XIP_STATS
+#include "util/xip.h"
+#endif
+
+struct Bench;
+
+// Apps past MAX_APPS are left out of the list instead of overrunning it
 #define APP(__name, __instance)                                 \
   __attribute__((constructor(255))) void __init_ ## __name() {  \
-    apps.buffer[apps.size].name = #__name;                      \
-    apps.buffer[apps.size].app = __instance;                    \
-    apps.size++;                                                \
+    if (apps.size < MAX_APPS) {                                 \
+      apps.buffer[apps.size].name = #__name;                    \
+      apps.buffer[apps.size].app = __instance;                  \
+      apps.size++;                                              \
+    }                                                           \
   }
 
 struct App {
   virtual ~App() = default;
 
+  // Called once during startup, for precomputing tables and loading saved state
+  virtual void prepare() {}
+
   virtual void init() = 0;
   virtual void update(uint32_t tick) = 0;
   virtual void draw(uint32_t tick) = 0;
+
+  // Called when Loader switches away from the app
+  virtual void exit() {}
+
+  // Called by Loader on top of its own stats overlay
+  virtual void draw_info() {}
+
+  // Whether app animates on its own and needs full frame rate without input
+  virtual bool continuous() const { return false; }
+
+  // Adds app's own kernels to the Benchmark suite
+  virtual void bench(Bench & bench) {}
 };
 
 struct Application {
@@ -40,19 +68,45 @@ struct Loader {
       bool is_init    : 1;
       bool run_app    : 1;
       bool draw_info  : 1;
+      bool idle       : 1;
+      bool splash     : 1;
+      bool boot_done  : 1;
+      bool usb_open   : 1; // USB serial terminal was open last frame
     };
   } flags;
 
+  // Time since reset, in us
+  struct {
+    uint32_t init;
+    uint32_t prepared;
+    uint32_t first_frame;
+  } boot;
+
+#if USE_XIP_STATS
+  // XIP cache counters of last app update and draw (including rasterization)
+  struct {
+    XipCounter update;
+    XipCounter draw;
+  } xip;
+#endif
+
   int32_t app_idx;
-  Timeout startup_timeout;
+  Timeout idle_timeout;
+  uint32_t full_clock_khz;
 
   void init();
   void update(uint32_t tick);
   void draw(uint32_t tick);
 
+  void update_power();
+  void enter_idle();
+  void exit_idle();
+
+  void prepare_apps();
   void draw_startup_msg();
   void draw_apps();
   void draw_info();
+  void print_boot();
 };
 
 extern ApplicationList<MAX_APPS> apps;
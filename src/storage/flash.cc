@@ -0,0 +1,38 @@
+#include "storage/storage.h"
+#include "pico/multicore.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "hardware/regs/addressmap.h"
+
+OnboardFlash onboard_flash;
+
+const uint8_t * OnboardFlash::data(uint32_t offset) {
+  return (const uint8_t *) (XIP_BASE + offset);
+}
+
+// XIP is unavailable while flash is written, so core 1 (audio) is paused as well
+static uint32_t flash_lock() {
+  if (multicore_lockout_victim_is_initialized(1)) {
+    multicore_lockout_start_blocking();
+  }
+  return save_and_disable_interrupts();
+}
+
+static void flash_unlock(uint32_t ints) {
+  restore_interrupts(ints);
+  if (multicore_lockout_victim_is_initialized(1)) {
+    multicore_lockout_end_blocking();
+  }
+}
+
+void OnboardFlash::erase(uint32_t offset, uint32_t size) {
+  uint32_t ints = flash_lock();
+  flash_range_erase(offset, size);
+  flash_unlock(ints);
+}
+
+void OnboardFlash::program(uint32_t offset, const uint8_t * data, uint32_t size) {
+  uint32_t ints = flash_lock();
+  flash_range_program(offset, data, size);
+  flash_unlock(ints);
+}
@@ -0,0 +1,181 @@
+#include "storage/storage.h"
+#include "picosystem.hpp"
+
+using namespace picosystem;
+
+Storage::Storage(uint32_t offset, uint32_t slot_size, Flash * flash)
+  : stats{0, 0, 0, 0}, flash(flash), offset(offset), slot_size(slot_size) {}
+
+bool Storage::save_bitmap(const uint8_t * data, size_t size) {
+  uint32_t start = time_us();
+
+  Writer writer = begin(STORAGE_FORMAT_PACKBITS, size);
+  packbits_encode(data, size, writer);
+  bool result = end(writer, STORAGE_FORMAT_PACKBITS, size);
+
+  stats.save_us = time_us() - start;
+  return result;
+}
+
+bool Storage::load_bitmap(uint8_t * data, size_t size) {
+  uint32_t start = time_us();
+  uint32_t packed_size;
+
+  const uint8_t * packed = load(STORAGE_FORMAT_PACKBITS, size, packed_size);
+  bool result = packed && packbits_decode(packed, packed_size, data, size);
+
+  stats.load_us = time_us() - start;
+  return result;
+}
+
+bool Storage::save_pixels(const uint16_t * data, size_t count) {
+  uint32_t start = time_us();
+
+  Writer writer = begin(STORAGE_FORMAT_PALETTE_RLE, count * sizeof(uint16_t));
+  palette_rle_encode(data, count, writer);
+  bool result = end(writer, STORAGE_FORMAT_PALETTE_RLE, count * sizeof(uint16_t));
+
+  stats.save_us = time_us() - start;
+  return result;
+}
+
+bool Storage::load_pixels(uint16_t * data, size_t count) {
+  uint32_t start = time_us();
+  uint32_t packed_size;
+
+  const uint8_t * packed = load(STORAGE_FORMAT_PALETTE_RLE, count * sizeof(uint16_t), packed_size);
+  bool result = packed && palette_rle_decode(packed, packed_size, data, count);
+
+  stats.load_us = time_us() - start;
+  return result;
+}
+
+uint32_t Storage::ratio() const {
+  return stats.raw_size ? stats.size * 100 / stats.raw_size : 0;
+}
+
+void Storage::Writer::write(uint8_t byte) {
+  if (overflow) {
+    return;
+  }
+
+  crc = crc32_update(crc, byte);
+  storage->page[size++ % STORAGE_PAGE_SIZE] = byte;
+
+  if (size % STORAGE_PAGE_SIZE == 0) {
+    flush();
+  }
+}
+
+void Storage::Writer::flush() {
+  if (overflow || size == 0) {
+    return;
+  }
+
+  // Payload starts right after the header page
+  uint32_t page_offset = (size - 1) / STORAGE_PAGE_SIZE * STORAGE_PAGE_SIZE + STORAGE_PAGE_SIZE;
+
+  if (page_offset + STORAGE_PAGE_SIZE > storage->slot_size) {
+    overflow = true;
+    return;
+  }
+
+  if (size % STORAGE_PAGE_SIZE) {
+    memset(storage->page + size % STORAGE_PAGE_SIZE, 0xFF, STORAGE_PAGE_SIZE - size % STORAGE_PAGE_SIZE);
+  }
+
+  // Sectors are erased lazily, right before the first page in them is programmed
+  page_offset += storage->slot_offset(slot);
+  if (page_offset % STORAGE_SECTOR_SIZE == 0) {
+    storage->flash->erase(page_offset, STORAGE_SECTOR_SIZE);
+  }
+
+  storage->flash->program(page_offset, storage->page, STORAGE_PAGE_SIZE);
+}
+
+uint32_t Storage::slot_offset(uint32_t slot) const {
+  return offset + slot * slot_size;
+}
+
+const Storage::Header * Storage::header(uint32_t slot) {
+  return (const Header *) flash->data(slot_offset(slot));
+}
+
+int32_t Storage::latest(uint32_t format, uint32_t raw_size) {
+  int32_t result = -1;
+
+  for (uint32_t slot = 0; slot < STORAGE_SLOTS; ++slot) {
+    const Header * h = header(slot);
+
+    if (h->magic != STORAGE_MAGIC || h->format != format || h->raw_size != raw_size) {
+      continue;
+    }
+
+    if (h->size > slot_size - STORAGE_PAGE_SIZE) {
+      continue;
+    }
+
+    if (crc32(flash->data(slot_offset(slot) + STORAGE_PAGE_SIZE), h->size) != h->crc) {
+      continue;
+    }
+
+    if (result < 0 || (int32_t) (h->sequence - header(result)->sequence) > 0) {
+      result = slot;
+    }
+  }
+
+  return result;
+}
+
+Storage::Writer Storage::begin(uint32_t format, uint32_t raw_size) {
+  int32_t current = latest(format, raw_size);
+
+  Writer writer;
+  writer.storage = this;
+  writer.slot = current < 0 ? 0 : (current + 1) % STORAGE_SLOTS;
+  writer.sequence = current < 0 ? 0 : header(current)->sequence + 1;
+  writer.size = 0;
+  writer.crc = CRC32_INIT;
+  writer.overflow = false;
+
+  // Invalidates the target slot, its header shares the first sector with the payload
+  flash->erase(slot_offset(writer.slot), STORAGE_SECTOR_SIZE);
+
+  return writer;
+}
+
+bool Storage::end(Writer & writer, uint32_t format, uint32_t raw_size) {
+  if (writer.size % STORAGE_PAGE_SIZE) {
+    writer.flush();
+  }
+
+  if (writer.overflow) {
+    return false;
+  }
+
+  Header h = {STORAGE_MAGIC, writer.sequence, format, raw_size, writer.size, crc32_final(writer.crc)};
+
+  memset(page, 0xFF, STORAGE_PAGE_SIZE);
+  memcpy(page, &h, sizeof(h));
+  flash->program(slot_offset(writer.slot), page, STORAGE_PAGE_SIZE);
+
+  stats.raw_size = raw_size;
+  stats.size = writer.size;
+
+  return true;
+}
+
+const uint8_t * Storage::load(uint32_t format, uint32_t raw_size, uint32_t & size) {
+  int32_t slot = latest(format, raw_size);
+
+  if (slot < 0) {
+    return nullptr;
+  }
+
+  size = header(slot)->size;
+
+  stats.raw_size = raw_size;
+  stats.size = size;
+
+  return flash->data(slot_offset(slot) + STORAGE_PAGE_SIZE);
+}
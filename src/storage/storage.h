@@ -0,0 +1,115 @@
+#pragma once
+
+#include "util/util.h"
+#include "util/compress.h"
+#include "util/crc.h"
+#include "util/sparse_bitmap.h"
+#include <cstdint>
+#include <cstddef>
+
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES (16 * 1024 * 1024)
+#endif
+
+#define STORAGE_MAGIC               0x56415350 // "PSAV"
+#define STORAGE_PAGE_SIZE           256
+#define STORAGE_SECTOR_SIZE         4096
+#define STORAGE_SLOTS               2
+#define STORAGE_AUTOSAVE_TIMEOUT    5000
+
+#define STORAGE_FORMAT_PACKBITS     1
+#define STORAGE_FORMAT_PALETTE_RLE  2
+
+// Slot holds a header page followed by the payload, rounded up to whole sectors
+#define STORAGE_SLOT_SIZE(__payload) \
+  (((__payload) + STORAGE_PAGE_SIZE + STORAGE_SECTOR_SIZE - 1) / STORAGE_SECTOR_SIZE * STORAGE_SECTOR_SIZE)
+
+// Drawer canvas side in pixels, and chunks it can hold
+#define DRAWER_CANVAS_SIZE          (SCREEN_SIZE * 8)
+#define DRAWER_CANVAS_CHUNKS        96
+
+// Storage layout, placed at the end of flash
+#define STORAGE_DRAWER_SLOT_SIZE    STORAGE_SLOT_SIZE(PACKBITS_MAX_SIZE(SPARSE_BITMAP_SIZE(DRAWER_CANVAS_SIZE, DRAWER_CANVAS_SIZE, DRAWER_CANVAS_CHUNKS)))
+#define STORAGE_GEOMETRY_SLOT_SIZE  STORAGE_SLOT_SIZE(PALETTE_RLE_MAX_SIZE(SCREEN_SIZE * SCREEN_SIZE))
+#define STORAGE_SIZE                (STORAGE_SLOTS * (STORAGE_DRAWER_SLOT_SIZE + STORAGE_GEOMETRY_SLOT_SIZE))
+#define STORAGE_OFFSET              (PICO_FLASH_SIZE_BYTES - STORAGE_SIZE)
+#define STORAGE_DRAWER_OFFSET       STORAGE_OFFSET
+#define STORAGE_GEOMETRY_OFFSET     (STORAGE_DRAWER_OFFSET + STORAGE_SLOTS * STORAGE_DRAWER_SLOT_SIZE)
+
+// Raw access to flash, offsets are relative to the start of flash. Storage only
+// goes through this, so the format can be tested against a stand-in on the host.
+struct Flash {
+  virtual ~Flash() = default;
+
+  virtual const uint8_t * data(uint32_t offset) = 0;
+  virtual void erase(uint32_t offset, uint32_t size) = 0;
+  virtual void program(uint32_t offset, const uint8_t * data, uint32_t size) = 0;
+};
+
+// Flash the firmware runs from, in flash.cc
+struct OnboardFlash : Flash {
+  const uint8_t * data(uint32_t offset) override;
+  void erase(uint32_t offset, uint32_t size) override;
+  void program(uint32_t offset, const uint8_t * data, uint32_t size) override;
+};
+
+extern OnboardFlash onboard_flash;
+
+// Double-buffered save slots: a save goes to the slot not holding the latest
+// copy, and its header is programmed last, so an interrupted save leaves the
+// previous copy intact. Only the sectors the payload actually spans are erased.
+struct Storage {
+  struct Header {
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t format;
+    uint32_t raw_size;
+    uint32_t size;
+    uint32_t crc; // CRC-32 of the payload
+  };
+
+  struct Stats {
+    uint32_t save_us;
+    uint32_t load_us;
+    uint32_t raw_size;
+    uint32_t size;
+  } stats;
+
+  Flash * flash;
+  uint32_t offset;
+  uint32_t slot_size;
+
+  Storage(uint32_t offset, uint32_t slot_size, Flash * flash = &onboard_flash);
+
+  bool save_bitmap(const uint8_t * data, size_t size);
+  bool load_bitmap(uint8_t * data, size_t size);
+
+  bool save_pixels(const uint16_t * data, size_t count);
+  bool load_pixels(uint16_t * data, size_t count);
+
+  // Compressed size of the last save/load, in percent of the raw size
+  uint32_t ratio() const;
+
+private:
+  struct Writer {
+    Storage * storage;
+    uint32_t slot;
+    uint32_t sequence;
+    uint32_t size;
+    uint32_t crc;
+    bool overflow;
+
+    void write(uint8_t byte);
+    void flush();
+  };
+
+  uint8_t page[STORAGE_PAGE_SIZE];
+
+  uint32_t slot_offset(uint32_t slot) const;
+  const Header * header(uint32_t slot);
+  int32_t latest(uint32_t format, uint32_t raw_size);
+
+  Writer begin(uint32_t format, uint32_t raw_size);
+  bool end(Writer & writer, uint32_t format, uint32_t raw_size);
+  const uint8_t * load(uint32_t format, uint32_t raw_size, uint32_t & size);
+};
@@ -4,27 +4,29 @@
 #include <cstdint>
 #include <cstring>
 
+#define BITMAP_WORD_BITS 32
+
 template <size_t N>
 struct Bitmap {
-  uint8_t buffer[N / 8];
+  uint32_t buffer[(N + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS];
 
   size_t size() const {
     return N;
   }
 
   void clear() {
-    memset(buffer, 0, N / 8);
+    memset(buffer, 0, sizeof(buffer));
   }
 
-  bool get(uint32_t i) {
-    return buffer[i / 8] & (1 << (i % 8));
+  bool get(uint32_t i) const {
+    return buffer[i / BITMAP_WORD_BITS] & (1u << (i % BITMAP_WORD_BITS));
   }
 
   void set(uint32_t i, bool value) {
     if (value) {
-      buffer[i / 8] |= (1 << (i % 8));
+      buffer[i / BITMAP_WORD_BITS] |= (1u << (i % BITMAP_WORD_BITS));
     } else {
-      buffer[i / 8] &= ~(1 << (i % 8));
+      buffer[i / BITMAP_WORD_BITS] &= ~(1u << (i % BITMAP_WORD_BITS));
     }
   }
 };
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Encoders stream their output one byte at a time into writer.write(uint8_t),
+// decoders expand straight into the destination buffer
+
+#define PACKBITS_MAX_RUN          128
+#define PACKBITS_MAX_SIZE(__n)    ((__n) + ((__n) + PACKBITS_MAX_RUN - 1) / PACKBITS_MAX_RUN)
+
+#define PALETTE_RLE_COLORS        15
+#define PALETTE_RLE_LITERAL       0xF
+#define PALETTE_RLE_SHORT_RUN     15
+#define PALETTE_RLE_MAX_RUN       (PALETTE_RLE_SHORT_RUN + 1 + 0xFFFF)
+#define PALETTE_RLE_MAX_SIZE(__n) (1 + 2 * PALETTE_RLE_COLORS + 2 * (__n) + 3 * ((__n) / PALETTE_RLE_MAX_RUN + 2))
+
+// PackBits: header n in [0, 127] is followed by n + 1 literal bytes,
+// n in [-127, -1] is followed by a single byte repeated 1 - n times
+template <typename Writer>
+void packbits_encode(const uint8_t * src, size_t size, Writer & writer) {
+  size_t i = 0;
+
+  while (i < size) {
+    size_t run = 1;
+    while (i + run < size && run < PACKBITS_MAX_RUN && src[i + run] == src[i]) {
+      run++;
+    }
+
+    if (run > 1) {
+      writer.write((uint8_t) (1 - (int32_t) run));
+      writer.write(src[i]);
+      i += run;
+      continue;
+    }
+
+    // Literal lasts until three equal bytes in a row, which are cheaper as a run
+    size_t literal = 1;
+    while (i + literal < size && literal < PACKBITS_MAX_RUN) {
+      if (i + literal + 2 < size && src[i + literal] == src[i + literal + 1] && src[i + literal] == src[i + literal + 2]) {
+        break;
+      }
+      literal++;
+    }
+
+    writer.write((uint8_t) (literal - 1));
+    for (size_t j = 0; j < literal; ++j) {
+      writer.write(src[i + j]);
+    }
+    i += literal;
+  }
+}
+
+inline bool packbits_decode(const uint8_t * src, size_t src_size, uint8_t * dst, size_t dst_size) {
+  size_t i = 0, o = 0;
+
+  while (i < src_size && o < dst_size) {
+    int8_t n = (int8_t) src[i++];
+
+    if (n >= 0) {
+      size_t count = n + 1;
+      if (i + count > src_size || o + count > dst_size) {
+        return false;
+      }
+      memcpy(dst + o, src + i, count);
+      i += count;
+      o += count;
+    } else if (n != -128) {
+      size_t count = 1 - n;
+      if (i >= src_size || o + count > dst_size) {
+        return false;
+      }
+      memset(dst + o, src[i++], count);
+      o += count;
+    }
+  }
+
+  return o == dst_size;
+}
+
+// Palette+RLE for 16-bit pixels: palette size, palette colors (LE), then tokens.
+// Token is (index << 4) | n, run length is n + 1, or 16 + following LE uint16 when n is 15.
+// Index PALETTE_RLE_LITERAL is followed by raw pixels for colors not in the palette.
+namespace palette_rle {
+
+inline int32_t find(const uint16_t * palette, uint32_t size, uint16_t color) {
+  for (uint32_t i = 0; i < size; ++i) {
+    if (palette[i] == color) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+inline size_t run_length(const uint16_t * src, size_t i, size_t size) {
+  size_t run = 1;
+  while (i + run < size && run < PALETTE_RLE_MAX_RUN && src[i + run] == src[i]) {
+    run++;
+  }
+  return run;
+}
+
+template <typename Writer>
+void write_u16(Writer & writer, uint16_t value) {
+  writer.write(value & 0xFF);
+  writer.write(value >> 8);
+}
+
+template <typename Writer>
+void write_token(Writer & writer, uint8_t index, size_t length) {
+  if (length <= PALETTE_RLE_SHORT_RUN) {
+    writer.write((index << 4) | (length - 1));
+  } else {
+    writer.write((index << 4) | PALETTE_RLE_SHORT_RUN);
+    write_u16(writer, length - PALETTE_RLE_SHORT_RUN - 1);
+  }
+}
+
+} // namespace palette_rle
+
+template <typename Writer>
+void palette_rle_encode(const uint16_t * src, size_t size, Writer & writer) {
+  using namespace palette_rle;
+
+  uint16_t palette[PALETTE_RLE_COLORS];
+  uint32_t palette_size = 0;
+
+  for (size_t i = 0; i < size && palette_size < PALETTE_RLE_COLORS; i += run_length(src, i, size)) {
+    if (find(palette, palette_size, src[i]) < 0) {
+      palette[palette_size++] = src[i];
+    }
+  }
+
+  writer.write(palette_size);
+  for (uint32_t i = 0; i < palette_size; ++i) {
+    write_u16(writer, palette[i]);
+  }
+
+  size_t i = 0;
+  while (i < size) {
+    int32_t index = find(palette, palette_size, src[i]);
+
+    if (index >= 0) {
+      size_t run = run_length(src, i, size);
+      write_token(writer, index, run);
+      i += run;
+      continue;
+    }
+
+    size_t literal = 1;
+    while (i + literal < size && literal < PALETTE_RLE_MAX_RUN && find(palette, palette_size, src[i + literal]) < 0) {
+      literal++;
+    }
+
+    write_token(writer, PALETTE_RLE_LITERAL, literal);
+    for (size_t j = 0; j < literal; ++j) {
+      write_u16(writer, src[i + j]);
+    }
+    i += literal;
+  }
+}
+
+inline bool palette_rle_decode(const uint8_t * src, size_t src_size, uint16_t * dst, size_t dst_size) {
+  if (src_size < 1 || src[0] > PALETTE_RLE_COLORS || src_size < 1 + 2u * src[0]) {
+    return false;
+  }
+
+  uint32_t palette_size = src[0];
+  const uint8_t * palette = src + 1;
+  size_t i = 1 + 2 * palette_size, o = 0;
+
+  while (i < src_size && o < dst_size) {
+    uint8_t index = src[i] >> 4;
+    size_t length = (src[i++] & 0xF) + 1;
+
+    if (length > PALETTE_RLE_SHORT_RUN) {
+      if (i + 2 > src_size) {
+        return false;
+      }
+      length += src[i] | (src[i + 1] << 8);
+      i += 2;
+    }
+
+    if (o + length > dst_size) {
+      return false;
+    }
+
+    if (index == PALETTE_RLE_LITERAL) {
+      if (i + 2 * length > src_size) {
+        return false;
+      }
+      for (size_t j = 0; j < length; ++j, i += 2) {
+        dst[o++] = src[i] | (src[i + 1] << 8);
+      }
+    } else if (index < palette_size) {
+      uint16_t color = palette[2 * index] | (palette[2 * index + 1] << 8);
+      for (size_t j = 0; j < length; ++j) {
+        dst[o++] = color;
+      }
+    } else {
+      return false;
+    }
+  }
+
+  return o == dst_size;
+}
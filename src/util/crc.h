@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#define CRC32_INIT 0xFFFFFFFF
+
+// CRC-32 (IEEE 802.3), processed a nibble at a time to keep the table small.
+// Running value starts at CRC32_INIT, the final CRC is its complement
+inline uint32_t crc32_update(uint32_t crc, uint8_t byte) {
+  static const uint32_t table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+  };
+
+  crc = table[(crc ^ byte) & 0xF] ^ (crc >> 4);
+  crc = table[(crc ^ (byte >> 4)) & 0xF] ^ (crc >> 4);
+  return crc;
+}
+
+inline uint32_t crc32_final(uint32_t crc) {
+  return ~crc;
+}
+
+// Same value as zlib's crc32() or Python's binascii.crc32()
+inline uint32_t crc32(const uint8_t * data, size_t size) {
+  uint32_t crc = CRC32_INIT;
+
+  for (size_t i = 0; i < size; ++i) {
+    crc = crc32_update(crc, data[i]);
+  }
+
+  return crc32_final(crc);
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "util/sparse_bitmap.h"
+#include "util/queue.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#define FILL_QUEUE_SIZE 1024
+
+// 1-bit canvas with scanline flood fill. Doesn't depend on the SDK, so it is
+// built on the host as well (host/fill_bench.cc).
+// Fill is all or nothing: chunks that were in use are copied before fill first
+// changes them, so a fill that doesn't fit is undone. That costs one more pool of memory.
+template <size_t W, size_t H, size_t N>
+struct FillMap {
+  SparseBitmap<W, H, N> bitmap;
+
+  size_t width() const {
+    return W;
+  }
+
+  size_t height() const {
+    return H;
+  }
+
+  void clear() {
+    bitmap.clear();
+  }
+
+  bool get(uint32_t x, uint32_t y) const {
+    return bitmap.get(x, y);
+  }
+
+  bool set(uint32_t x, uint32_t y, bool value) {
+    return bitmap.set(x, y, value);
+  }
+
+  // Scanline flood fill of the 4-connected region around (x, y) that differs from value
+  // Pending spans are taken oldest first, so the fill sweeps the region row by row and
+  // only its frontier is queued. Newest first piles up siblings of every visited row instead.
+  // Returns false if fill queue overflowed or chunk pool ran out, canvas is left as it was then
+  bool fill(uint32_t x, uint32_t y, bool value) {
+    if (get(x, y) == value) {
+      return true;
+    }
+
+    begin_undo();
+
+    fill_queue.clear();
+    fill_queue.push({(uint16_t) x, (uint16_t) (x + 1), (uint16_t) y, 1});
+    fill_queue.push({(uint16_t) x, (uint16_t) (x + 1), (uint16_t) (y - 1), -1});
+
+    while (!fill_queue.empty()) {
+      FillSpan span = fill_queue.pop();
+
+      if (span.y >= H) {
+        continue;
+      }
+
+      uint32_t i = bitmap.find(span.y, span.x1, span.x2, !value);
+
+      while (i < span.x2) {
+        uint32_t left = bitmap.rfind(span.y, 0, i, value);
+        uint32_t right = bitmap.find(span.y, i, W, value);
+
+        save_chunks(span.y, left, right);
+
+        // Continue in the same direction over the whole run, and back over
+        // the parts that overhang the span this run was reached from
+        bool complete = bitmap.fill(span.y, left, right, value)
+          && push_span(left, right, span.y + span.dy, span.dy)
+          && (left >= span.x1 || push_span(left, span.x1, span.y - span.dy, -span.dy))
+          && (right <= span.x2 || push_span(span.x2, right, span.y - span.dy, -span.dy));
+
+        if (!complete) {
+          undo();
+          return false;
+        }
+
+        i = bitmap.find(span.y, right, span.x2, !value);
+      }
+    }
+
+    return true;
+  }
+
+private:
+  struct FillSpan {
+    uint16_t x1, x2;
+    uint16_t y;
+    int16_t dy;
+  };
+
+  Queue<FillSpan, FILL_QUEUE_SIZE> fill_queue;
+
+  // Undo state of the current fill, by pool slot
+  typename SparseBitmap<W, H, N>::Chunk saved[N]; // Contents before fill changed it
+  uint16_t saved_cell[N];                         // Index cell of slots in use when fill started
+  bool is_saved[N];
+
+  void begin_undo() {
+    memset(saved_cell, 0xFF, sizeof(saved_cell));
+    memset(is_saved, 0, sizeof(is_saved));
+
+    for (uint32_t cell = 0; cell < sizeof(bitmap.data.index) / sizeof(bitmap.data.index[0]); ++cell) {
+      if (bitmap.data.index[cell] != SPARSE_NO_CHUNK) {
+        saved_cell[bitmap.data.index[cell]] = cell;
+      }
+    }
+  }
+
+  // Copies chunks under [from, to) of row y that were in use before fill, unless copied already
+  void save_chunks(uint32_t y, uint32_t from, uint32_t to) {
+    uint32_t row = (y / SPARSE_CHUNK_BITS) * bitmap.COLS;
+
+    for (uint32_t cx = from / SPARSE_CHUNK_BITS; cx <= (to - 1) / SPARSE_CHUNK_BITS; ++cx) {
+      uint16_t slot = bitmap.data.index[row + cx];
+
+      if (slot != SPARSE_NO_CHUNK && saved_cell[slot] != SPARSE_NO_CHUNK && !is_saved[slot]) {
+        saved[slot] = bitmap.data.pool[slot];
+        is_saved[slot] = true;
+      }
+    }
+  }
+
+  // Releases chunks taken by fill and puts back the saved ones, some of them could have been freed
+  void undo() {
+    for (uint16_t & slot : bitmap.data.index) {
+      if (slot != SPARSE_NO_CHUNK && saved_cell[slot] == SPARSE_NO_CHUNK) {
+        memset(&bitmap.data.pool[slot], 0, sizeof(bitmap.data.pool[slot]));
+        slot = SPARSE_NO_CHUNK;
+      }
+    }
+
+    for (uint16_t slot = 0; slot < N; ++slot) {
+      if (is_saved[slot]) {
+        bitmap.data.pool[slot] = saved[slot];
+        bitmap.data.index[saved_cell[slot]] = slot;
+      }
+    }
+
+    bitmap.restore();
+  }
+
+  bool push_span(uint32_t from, uint32_t to, uint32_t y, int16_t dy) {
+    if (y >= H) {
+      return true;
+    }
+
+    return fill_queue.push({(uint16_t) from, (uint16_t) to, (uint16_t) y, dy});
+  }
+};
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "util/vec2.h"
+#include "util/vec3.h"
+#include <cstdint>
+
+// Integer square root of a 32-bit value, rounded down. Newton's method, seeded with a
+// power of two above the root from the bit length, only steps down towards the root.
+constexpr uint32_t isqrt32(uint32_t value) {
+  if (value < 2) {
+    return value;
+  }
+
+  uint32_t x = 1u << ((33 - __builtin_clz(value)) / 2);
+  uint32_t y = (x + value / x) / 2;
+
+  while (y < x) {
+    x = y;
+    y = (x + value / x) / 2;
+  }
+
+  return x;
+}
+
+// Integer square root, rounded down. Wider values are seeded with the root of their top
+// 32 bits, which is close enough that one 64-bit division and a correction finish it.
+constexpr uint32_t isqrt(uint64_t value) {
+  if (value <= UINT32_MAX) {
+    return isqrt32(value);
+  }
+
+  int32_t shift = (64 - __builtin_clzll(value) - 31) & ~1;
+  uint64_t x = (uint64_t) (isqrt32(value >> shift) + 1) << (shift / 2);
+  uint64_t y = (x + value / x) / 2;
+
+  y = y > UINT32_MAX ? UINT32_MAX : y;
+  while (y * y > value) {
+    --y;
+  }
+
+  return y;
+}
+
+// Signed fixed-point number with IntBits integer bits (sign included) and FracBits fractional bits
+template <int32_t IntBits, int32_t FracBits>
+struct Fixed {
+  static_assert(IntBits + FracBits <= 32, "Fixed must fit in 32 bits");
+
+  static constexpr int32_t ONE = 1 << FracBits;
+
+  int32_t raw;
+
+  constexpr Fixed() : raw(0) {}
+  constexpr Fixed(int32_t value) : raw(value * ONE) {}
+  constexpr explicit Fixed(float value) : raw(value * ONE) {}
+  constexpr explicit Fixed(double value) : raw(value * ONE) {}
+
+  static constexpr Fixed from_raw(int32_t raw) {
+    Fixed result;
+    result.raw = raw;
+    return result;
+  }
+
+  static constexpr Fixed max() {
+    return from_raw(INT32_MAX >> (32 - IntBits - FracBits));
+  }
+
+  constexpr explicit operator float() const {
+    return raw / (float) ONE;
+  }
+
+  constexpr explicit operator double() const {
+    return raw / (double) ONE;
+  }
+
+  // Rounds towards negative infinity
+  constexpr int32_t to_int() const {
+    return raw >> FracBits;
+  }
+
+  constexpr Fixed fract() const {
+    return from_raw(raw & (ONE - 1));
+  }
+
+  constexpr Fixed operator-() const {
+    return from_raw(-raw);
+  }
+
+  constexpr Fixed& operator+=(Fixed rhs) {
+    raw += rhs.raw;
+    return *this;
+  }
+
+  constexpr Fixed& operator-=(Fixed rhs) {
+    raw -= rhs.raw;
+    return *this;
+  }
+
+  constexpr Fixed& operator*=(Fixed rhs) {
+    raw = ((int64_t) raw * rhs.raw) >> FracBits;
+    return *this;
+  }
+
+  constexpr Fixed& operator/=(Fixed rhs) {
+    raw = ((int64_t) raw * ONE) / rhs.raw;
+    return *this;
+  }
+
+  friend constexpr Fixed operator+(Fixed lhs, Fixed rhs) { return lhs += rhs; }
+  friend constexpr Fixed operator-(Fixed lhs, Fixed rhs) { return lhs -= rhs; }
+  friend constexpr Fixed operator*(Fixed lhs, Fixed rhs) { return lhs *= rhs; }
+  friend constexpr Fixed operator/(Fixed lhs, Fixed rhs) { return lhs /= rhs; }
+
+  friend constexpr bool operator==(Fixed lhs, Fixed rhs) { return lhs.raw == rhs.raw; }
+  friend constexpr bool operator!=(Fixed lhs, Fixed rhs) { return lhs.raw != rhs.raw; }
+  friend constexpr bool operator<(Fixed lhs, Fixed rhs) { return lhs.raw < rhs.raw; }
+  friend constexpr bool operator>(Fixed lhs, Fixed rhs) { return lhs.raw > rhs.raw; }
+  friend constexpr bool operator<=(Fixed lhs, Fixed rhs) { return lhs.raw <= rhs.raw; }
+  friend constexpr bool operator>=(Fixed lhs, Fixed rhs) { return lhs.raw >= rhs.raw; }
+
+  friend constexpr Fixed abs(Fixed value) {
+    return value.raw < 0 ? -value : value;
+  }
+
+  friend constexpr Fixed sqrt(Fixed value) {
+    return from_raw(value.raw > 0 ? isqrt((uint64_t) value.raw << FracBits) : 0);
+  }
+
+  // 1 / value, saturated to max() for values too close to 0
+  friend constexpr Fixed reciprocal(Fixed value) {
+    int64_t result = ((int64_t) 1 << (2 * FracBits)) / (value.raw ? value.raw : 1);
+
+    if (result > max().raw) {
+      return max();
+    }
+
+    if (result < -max().raw) {
+      return -max();
+    }
+
+    return from_raw(result);
+  }
+};
+
+using fixed_t = Fixed<16, 16>;
+
+// Fixed-point vectors divide once for the reciprocal of the length, instead of once per component
+template <int32_t IntBits, int32_t FracBits>
+constexpr Vec2<Fixed<IntBits, FracBits>> normalize(Vec2<Fixed<IntBits, FracBits>> v) {
+  return v * reciprocal(sqrt(length_squared(v)));
+}
+
+template <int32_t IntBits, int32_t FracBits>
+constexpr Vec3<Fixed<IntBits, FracBits>> normalize(Vec3<Fixed<IntBits, FracBits>> v) {
+  return v * reciprocal(sqrt(length_squared(v)));
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#if __has_include("pico/platform.h")
+#include "pico/platform.h"
+#endif
+
+#define USE_SRAM_HOT_PATHS 1
+
+// Code runs from external flash through a 16 KB XIP cache, shared by both cores.
+// Hot functions and tables marked with these are copied to SRAM at startup instead,
+// so they neither miss in the cache nor evict other code from it. Hot functions
+// aren't inlined, otherwise their body would end up in a caller left in flash.
+// Host builds have no SDK and no flash, so the markers expand to nothing there.
+#if USE_SRAM_HOT_PATHS && defined(__not_in_flash_func)
+#define HOT_FUNC(__name)  __noinline __not_in_flash_func(__name)
+#define HOT_DATA(__group) __not_in_flash(__group)
+#else
+#define HOT_FUNC(__name)  __name
+#define HOT_DATA(__group)
+#endif
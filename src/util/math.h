@@ -20,6 +20,21 @@ constexpr T cap(T value, T min, T max) {
   return value;
 }
 
+template <typename T>
+constexpr Vec2<T> abs_diff(Vec2<T> a, Vec2<T> b) {
+  return {abs_diff(a.x, b.x), abs_diff(a.y, b.y)};
+}
+
+template <typename T>
+constexpr Vec2<T> cap(Vec2<T> value, Vec2<T> min, Vec2<T> max) {
+  return {cap(value.x, min.x, max.x), cap(value.y, min.y, max.y)};
+}
+
+template <typename T>
+constexpr Vec2<T> min(Vec2<T> a, Vec2<T> b) {
+  return {a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y};
+}
+
 template <typename T, typename R = T>
 R scale(T value, Vec2<T> val_constraints, Vec2<R> res_constraints) {
   return ((value - val_constraints.x) / (val_constraints.y - val_constraints.x)) * (res_constraints.y - res_constraints.x) + res_constraints.x;
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+// Fixed-size FIFO ring buffer, the first-in-first-out counterpart of Stack
+template <typename T, size_t N>
+struct Queue {
+  T buffer[N];
+  size_t head = 0; // Index of the oldest element
+  size_t size = 0;
+
+  size_t capacity() const {
+    return N;
+  }
+
+  bool empty() const {
+    return size == 0;
+  }
+
+  void clear() {
+    head = 0;
+    size = 0;
+  }
+
+  bool push(const T& value) {
+    if (size == N) {
+      return false;
+    }
+
+    buffer[(head + size++) % N] = value;
+    return true;
+  }
+
+  T pop() {
+    T value = buffer[head];
+    head = (head + 1) % N;
+    size--;
+    return value;
+  }
+};
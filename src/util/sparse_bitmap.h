@@ -0,0 +1,189 @@
+#pragma once
+
+#include "util/stack.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#define SPARSE_CHUNK_BITS  32 // Chunk is 32x32 bits, one word per row
+#define SPARSE_NO_CHUNK    0xFFFF
+
+#define SPARSE_CHUNKS(__n)                  (((__n) + SPARSE_CHUNK_BITS - 1) / SPARSE_CHUNK_BITS)
+#define SPARSE_INDEX_SIZE(__w, __h)         ((SPARSE_CHUNKS(__w) * SPARSE_CHUNKS(__h) * 2 + 3) / 4 * 4)
+#define SPARSE_BITMAP_SIZE(__w, __h, __n)   (SPARSE_INDEX_SIZE(__w, __h) + (__n) * SPARSE_CHUNK_BITS * 4) // Bytes of data
+
+// W x H bitmap stored as 32x32 chunks. A chunk is taken from a pool of N when
+// a bit is first set in it, and returned once all of its bits are cleared.
+// Missing chunks read as zeros, so memory follows what was drawn, not W x H.
+// Rows are addressed by y, bits within a row by x, like in Bitmap.
+template <size_t W, size_t H, size_t N>
+struct SparseBitmap {
+  static constexpr uint32_t COLS = SPARSE_CHUNKS(W);
+  static constexpr uint32_t ROWS = SPARSE_CHUNKS(H);
+
+  static_assert(N < SPARSE_NO_CHUNK, "Chunk pool is too big for 16-bit index");
+
+  struct Chunk {
+    uint32_t rows[SPARSE_CHUNK_BITS];
+  };
+
+  // Kept in one block, so the bitmap can be saved and loaded as is
+  struct {
+    uint16_t index[ROWS * COLS]; // Pool slot of each chunk, or SPARSE_NO_CHUNK
+    Chunk    pool[N];            // Free chunks are all zeros
+  } data;
+
+  static_assert(sizeof(data) == SPARSE_BITMAP_SIZE(W, H, N), "SPARSE_BITMAP_SIZE doesn't match layout");
+
+  Stack<uint16_t, N> free_chunks;
+
+  size_t width() const {
+    return W;
+  }
+
+  size_t height() const {
+    return H;
+  }
+
+  size_t used() const {
+    return N - free_chunks.size;
+  }
+
+  size_t capacity() const {
+    return N;
+  }
+
+  void clear() {
+    memset(data.index, 0xFF, sizeof(data.index));
+    memset(data.pool, 0, sizeof(data.pool));
+    restore();
+  }
+
+  // Rebuilds free list from index, after data was loaded. Returns false if index is inconsistent
+  bool restore() {
+    bool taken[N] = {};
+
+    for (uint16_t slot : data.index) {
+      if (slot == SPARSE_NO_CHUNK) {
+        continue;
+      }
+
+      if (slot >= N || taken[slot]) {
+        return false;
+      }
+
+      taken[slot] = true;
+    }
+
+    free_chunks.clear();
+    for (size_t slot = N; slot-- > 0;) {
+      if (!taken[slot]) {
+        free_chunks.push(slot);
+      }
+    }
+
+    return true;
+  }
+
+  // Chunk at chunk coordinates, nullptr if it is empty
+  const Chunk * chunk(uint32_t cx, uint32_t cy) const {
+    uint16_t slot = data.index[cy * COLS + cx];
+    return slot == SPARSE_NO_CHUNK ? nullptr : &data.pool[slot];
+  }
+
+  bool get(uint32_t x, uint32_t y) const {
+    return word(x / SPARSE_CHUNK_BITS, y) & (1u << (x % SPARSE_CHUNK_BITS));
+  }
+
+  // Returns false if bit had to be set, but chunk pool is exhausted
+  bool set(uint32_t x, uint32_t y, bool value) {
+    return fill(y, x, x + 1, value);
+  }
+
+  // Returns x of first bit in [from, to) of row y equal to value, or `to` if there is none
+  uint32_t find(uint32_t y, uint32_t from, uint32_t to, bool value) const {
+    while (from < to) {
+      uint32_t word = word_of(from, y, value) & (~0u << (from % SPARSE_CHUNK_BITS));
+
+      if (word) {
+        uint32_t x = (from & ~(SPARSE_CHUNK_BITS - 1)) + __builtin_ctz(word);
+        return x < to ? x : to;
+      }
+
+      from = (from & ~(SPARSE_CHUNK_BITS - 1)) + SPARSE_CHUNK_BITS;
+    }
+
+    return to;
+  }
+
+  // Returns x one past the last bit in [from, to) of row y equal to value, or `from` if there is none
+  uint32_t rfind(uint32_t y, uint32_t from, uint32_t to, bool value) const {
+    while (to > from) {
+      uint32_t last = to - 1;
+      uint32_t word = word_of(last, y, value) & (~0u >> (SPARSE_CHUNK_BITS - 1 - last % SPARSE_CHUNK_BITS));
+
+      if (word) {
+        uint32_t x = (last & ~(SPARSE_CHUNK_BITS - 1)) + SPARSE_CHUNK_BITS - __builtin_clz(word);
+        return x > from ? x : from;
+      }
+
+      to = last & ~(SPARSE_CHUNK_BITS - 1);
+    }
+
+    return from;
+  }
+
+  // Sets bits [from, to) of row y to value. Returns false if a chunk was needed,
+  // but the pool is exhausted; bits before that one are set already
+  bool fill(uint32_t y, uint32_t from, uint32_t to, bool value) {
+    while (from < to) {
+      uint32_t bit = from % SPARSE_CHUNK_BITS;
+      uint32_t count = SPARSE_CHUNK_BITS - bit < to - from ? SPARSE_CHUNK_BITS - bit : to - from;
+      uint32_t mask = (count == SPARSE_CHUNK_BITS ? ~0u : (1u << count) - 1) << bit;
+      uint16_t & slot = data.index[(y / SPARSE_CHUNK_BITS) * COLS + from / SPARSE_CHUNK_BITS];
+
+      if (value) {
+        if (slot == SPARSE_NO_CHUNK) {
+          if (free_chunks.empty()) {
+            return false;
+          }
+          slot = free_chunks.pop();
+        }
+
+        data.pool[slot].rows[y % SPARSE_CHUNK_BITS] |= mask;
+      } else if (slot != SPARSE_NO_CHUNK) {
+        data.pool[slot].rows[y % SPARSE_CHUNK_BITS] &= ~mask;
+
+        if (!data.pool[slot].rows[y % SPARSE_CHUNK_BITS] && empty(data.pool[slot])) {
+          free_chunks.push(slot);
+          slot = SPARSE_NO_CHUNK;
+        }
+      }
+
+      from += count;
+    }
+
+    return true;
+  }
+
+private:
+  uint32_t word(uint32_t cx, uint32_t y) const {
+    const Chunk * c = chunk(cx, y / SPARSE_CHUNK_BITS);
+    return c ? c->rows[y % SPARSE_CHUNK_BITS] : 0;
+  }
+
+  // Word containing bit x of row y, inverted when searching for cleared bits
+  uint32_t word_of(uint32_t x, uint32_t y, bool value) const {
+    uint32_t w = word(x / SPARSE_CHUNK_BITS, y);
+    return value ? w : ~w;
+  }
+
+  static bool empty(const Chunk & c) {
+    for (uint32_t row : c.rows) {
+      if (row) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
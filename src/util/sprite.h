@@ -0,0 +1,149 @@
+#pragma once
+
+#include "picosystem.hpp"
+#include "util/stack.h"
+#include "util/hot.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Sprites with run-length encoded transparency. Every row is a sequence of
+// [skip, copy, copy colors...] runs: skip transparent pixels, then copy opaque ones.
+// rows[y] is the offset of row y in data, so clipped rows are skipped without decoding.
+// Pixels with alpha 0 are transparent, all others are copied as is.
+
+#define SPRITE_BATCH_SIZE           32
+#define SPRITE_MAX_SIZE(__w, __h)   ((__h) * ((__w) * 3 / 2 + 2)) // Words of data, worst case
+
+struct Sprite {
+  int16_t w, h;
+  const uint16_t * rows;
+  const uint16_t * data;
+};
+
+// Clip rectangle, x2 and y2 exclusive
+struct SpriteClip {
+  int32_t x1, y1, x2, y2;
+
+  bool empty() const {
+    return x1 >= x2 || y1 >= y2;
+  }
+
+  SpriteClip intersect(const SpriteClip & other) const {
+    return {std::max(x1, other.x1), std::max(y1, other.y1), std::min(x2, other.x2), std::min(y2, other.y2)};
+  }
+};
+
+// Encodes src into rows (src->h entries) and data, fails if data doesn't fit into capacity words
+inline bool sprite_encode(const picosystem::buffer_t * src, uint16_t * rows, uint16_t * data, size_t capacity, Sprite & sprite) {
+  const picosystem::color_t alpha = picosystem::rgb(0, 0, 0, 0xF);
+  size_t size = 0;
+
+  for (int32_t y = 0; y < src->h; ++y) {
+    const picosystem::color_t * row = src->data + y * src->w;
+    rows[y] = size;
+
+    for (int32_t x = 0; x < src->w;) {
+      int32_t skip = 0, copy = 0;
+
+      while (x + skip < src->w && !(row[x + skip] & alpha)) {
+        skip++;
+      }
+      x += skip;
+
+      while (x + copy < src->w && (row[x + copy] & alpha)) {
+        copy++;
+      }
+
+      if (size + 2 + copy > capacity) {
+        return false;
+      }
+
+      data[size++] = skip;
+      data[size++] = copy;
+      memcpy(data + size, row + x, copy * sizeof(uint16_t));
+      size += copy;
+      x += copy;
+    }
+  }
+
+  sprite = {(int16_t) src->w, (int16_t) src->h, rows, data};
+  return true;
+}
+
+// Draws sprite with its top left corner at x, y of dst, limited to clip
+inline void HOT_FUNC(sprite_blit)(picosystem::buffer_t * dst, const Sprite & sprite, int32_t x, int32_t y, SpriteClip clip) {
+  clip = clip.intersect({0, 0, dst->w, dst->h}).intersect({x, y, x + sprite.w, y + sprite.h});
+
+  if (clip.empty()) {
+    return;
+  }
+
+  for (int32_t row = clip.y1; row < clip.y2; ++row) {
+    const uint16_t * run = sprite.data + sprite.rows[row - y];
+    picosystem::color_t * out = dst->data + row * dst->w;
+
+    for (int32_t px = x; px < clip.x2;) {
+      px += run[0];
+      int32_t copy = run[1];
+      const uint16_t * colors = run + 2;
+
+      int32_t from = std::max(px, clip.x1);
+      int32_t to = std::min(px + copy, clip.x2);
+      if (from < to) {
+        memcpy(out + from, colors + (from - px), (to - from) * sizeof(uint16_t));
+      }
+
+      px += copy;
+      run = colors + copy;
+    }
+  }
+}
+
+inline void sprite_blit(picosystem::buffer_t * dst, const Sprite & sprite, int32_t x, int32_t y) {
+  sprite_blit(dst, sprite, x, y, {0, 0, dst->w, dst->h});
+}
+
+// Sprites drawn together under one clip rectangle. Bounds of the whole batch are
+// tested first, so a batch outside of the target costs a single check.
+struct SpriteBatch {
+  struct Entry {
+    const Sprite * sprite;
+    int32_t x, y;
+  };
+
+  Stack<Entry, SPRITE_BATCH_SIZE> entries;
+  SpriteClip clip   = {INT16_MIN, INT16_MIN, INT16_MAX, INT16_MAX};
+  SpriteClip bounds = {INT16_MAX, INT16_MAX, INT16_MIN, INT16_MIN};
+
+  void clear() {
+    entries.clear();
+    bounds = {INT16_MAX, INT16_MAX, INT16_MIN, INT16_MIN};
+  }
+
+  bool add(const Sprite * sprite, int32_t x, int32_t y) {
+    if (!entries.push({sprite, x, y})) {
+      return false;
+    }
+
+    bounds.x1 = std::min(bounds.x1, x);
+    bounds.y1 = std::min(bounds.y1, y);
+    bounds.x2 = std::max(bounds.x2, x + sprite->w);
+    bounds.y2 = std::max(bounds.y2, y + sprite->h);
+    return true;
+  }
+
+  void draw(picosystem::buffer_t * dst) const {
+    SpriteClip visible = clip.intersect(bounds).intersect({0, 0, dst->w, dst->h});
+
+    if (visible.empty()) {
+      return;
+    }
+
+    for (size_t i = 0; i < entries.size; ++i) {
+      const Entry & e = entries.buffer[i];
+      sprite_blit(dst, *e.sprite, e.x, e.y, visible);
+    }
+  }
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+
+template <typename T, size_t N>
+struct Stack {
+  T buffer[N];
+  size_t size = 0;
+
+  size_t capacity() const {
+    return N;
+  }
+
+  bool empty() const {
+    return size == 0;
+  }
+
+  void clear() {
+    size = 0;
+  }
+
+  bool push(const T& value) {
+    if (size == N) {
+      return false;
+    }
+
+    buffer[size++] = value;
+    return true;
+  }
+
+  T pop() {
+    return buffer[--size];
+  }
+};
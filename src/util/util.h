@@ -4,8 +4,11 @@
 #include "util/vec2.h"
 #include "util/vec3.h"
 #include "util/math.h"
+#include "util/fixed.h"
 #include "util/bitmap.h"
+#include "util/stack.h"
 #include "util/timeout.h"
+#include "util/hot.h"
 
 #ifdef PIXEL_DOUBLE
 #define SCREEN_SIZE 120
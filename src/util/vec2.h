@@ -1,6 +1,109 @@
 #pragma once
 
+#include <cmath>
+#include <type_traits>
+
+// Scalar operand type, kept out of template deduction so that e.g. Vec2<Fixed> * 2 converts 2 to Fixed
+template <typename T>
+using VecScalar = typename std::common_type<T>::type;
+
 template <typename T>
 struct Vec2 {
   T x, y;
+
+  constexpr Vec2<T>& operator+=(Vec2<T> rhs) {
+    x += rhs.x;
+    y += rhs.y;
+    return *this;
+  }
+
+  constexpr Vec2<T>& operator-=(Vec2<T> rhs) {
+    x -= rhs.x;
+    y -= rhs.y;
+    return *this;
+  }
+
+  constexpr Vec2<T>& operator*=(VecScalar<T> rhs) {
+    x *= rhs;
+    y *= rhs;
+    return *this;
+  }
 };
+
+template <typename T>
+constexpr Vec2<T> operator+(Vec2<T> lhs, Vec2<T> rhs) {
+  return {lhs.x + rhs.x, lhs.y + rhs.y};
+}
+
+template <typename T>
+constexpr Vec2<T> operator-(Vec2<T> lhs, Vec2<T> rhs) {
+  return {lhs.x - rhs.x, lhs.y - rhs.y};
+}
+
+template <typename T>
+constexpr Vec2<T> operator-(Vec2<T> v) {
+  return {-v.x, -v.y};
+}
+
+template <typename T>
+constexpr Vec2<T> operator*(Vec2<T> v, VecScalar<T> s) {
+  return {v.x * s, v.y * s};
+}
+
+template <typename T>
+constexpr Vec2<T> operator*(VecScalar<T> s, Vec2<T> v) {
+  return {v.x * s, v.y * s};
+}
+
+template <typename T>
+constexpr Vec2<T> operator/(Vec2<T> v, VecScalar<T> s) {
+  return {v.x / s, v.y / s};
+}
+
+template <typename T>
+constexpr bool operator==(Vec2<T> lhs, Vec2<T> rhs) {
+  return lhs.x == rhs.x && lhs.y == rhs.y;
+}
+
+template <typename T>
+constexpr bool operator!=(Vec2<T> lhs, Vec2<T> rhs) {
+  return !(lhs == rhs);
+}
+
+template <typename T>
+constexpr T dot(Vec2<T> lhs, Vec2<T> rhs) {
+  return lhs.x * rhs.x + lhs.y * rhs.y;
+}
+
+// Z component of the 3D cross product
+template <typename T>
+constexpr T cross(Vec2<T> lhs, Vec2<T> rhs) {
+  return lhs.x * rhs.y - lhs.y * rhs.x;
+}
+
+template <typename T>
+constexpr T length_squared(Vec2<T> v) {
+  return dot(v, v);
+}
+
+template <typename T>
+T length(Vec2<T> v) {
+  using std::sqrt;
+  return sqrt(length_squared(v));
+}
+
+template <typename T>
+Vec2<T> normalize(Vec2<T> v) {
+  return v / length(v);
+}
+
+// Rotates counter-clockwise by angle given as its sine and cosine
+template <typename T>
+constexpr Vec2<T> rotate(Vec2<T> v, VecScalar<T> s, VecScalar<T> c) {
+  return {v.x * c - v.y * s, v.x * s + v.y * c};
+}
+
+template <typename R, typename T>
+constexpr Vec2<R> vec_cast(Vec2<T> v) {
+  return {static_cast<R>(v.x), static_cast<R>(v.y)};
+}
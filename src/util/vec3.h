@@ -1,6 +1,111 @@
 #pragma once
 
+#include "util/vec2.h"
+#include <cmath>
+
 template <typename T>
 struct Vec3 {
   T x, y, z;
+
+  constexpr Vec3<T>& operator+=(Vec3<T> rhs) {
+    x += rhs.x;
+    y += rhs.y;
+    z += rhs.z;
+    return *this;
+  }
+
+  constexpr Vec3<T>& operator-=(Vec3<T> rhs) {
+    x -= rhs.x;
+    y -= rhs.y;
+    z -= rhs.z;
+    return *this;
+  }
+
+  constexpr Vec3<T>& operator*=(VecScalar<T> rhs) {
+    x *= rhs;
+    y *= rhs;
+    z *= rhs;
+    return *this;
+  }
 };
+
+template <typename T>
+constexpr Vec3<T> operator+(Vec3<T> lhs, Vec3<T> rhs) {
+  return {lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z};
+}
+
+template <typename T>
+constexpr Vec3<T> operator-(Vec3<T> lhs, Vec3<T> rhs) {
+  return {lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z};
+}
+
+template <typename T>
+constexpr Vec3<T> operator-(Vec3<T> v) {
+  return {-v.x, -v.y, -v.z};
+}
+
+template <typename T>
+constexpr Vec3<T> operator*(Vec3<T> v, VecScalar<T> s) {
+  return {v.x * s, v.y * s, v.z * s};
+}
+
+template <typename T>
+constexpr Vec3<T> operator*(VecScalar<T> s, Vec3<T> v) {
+  return {v.x * s, v.y * s, v.z * s};
+}
+
+template <typename T>
+constexpr Vec3<T> operator/(Vec3<T> v, VecScalar<T> s) {
+  return {v.x / s, v.y / s, v.z / s};
+}
+
+template <typename T>
+constexpr bool operator==(Vec3<T> lhs, Vec3<T> rhs) {
+  return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z;
+}
+
+template <typename T>
+constexpr bool operator!=(Vec3<T> lhs, Vec3<T> rhs) {
+  return !(lhs == rhs);
+}
+
+template <typename T>
+constexpr T dot(Vec3<T> lhs, Vec3<T> rhs) {
+  return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+}
+
+template <typename T>
+constexpr Vec3<T> cross(Vec3<T> lhs, Vec3<T> rhs) {
+  return {
+    lhs.y * rhs.z - lhs.z * rhs.y,
+    lhs.z * rhs.x - lhs.x * rhs.z,
+    lhs.x * rhs.y - lhs.y * rhs.x
+  };
+}
+
+template <typename T>
+constexpr T length_squared(Vec3<T> v) {
+  return dot(v, v);
+}
+
+template <typename T>
+T length(Vec3<T> v) {
+  using std::sqrt;
+  return sqrt(length_squared(v));
+}
+
+template <typename T>
+Vec3<T> normalize(Vec3<T> v) {
+  return v / length(v);
+}
+
+// Rotates counter-clockwise around Z axis by angle given as its sine and cosine
+template <typename T>
+constexpr Vec3<T> rotate_z(Vec3<T> v, VecScalar<T> s, VecScalar<T> c) {
+  return {v.x * c - v.y * s, v.x * s + v.y * c, v.z};
+}
+
+template <typename R, typename T>
+constexpr Vec3<R> vec_cast(Vec3<T> v) {
+  return {static_cast<R>(v.x), static_cast<R>(v.y), static_cast<R>(v.z)};
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "hardware/structs/xip_ctrl.h"
+#include <cstdint>
+
+// XIP cache hit/access counters around a piece of code. Counters are global,
+// so accesses from core 1 (audio) running at the same time are counted as well.
+struct XipCounter {
+  uint32_t hit    = 0;
+  uint32_t access = 0;
+
+  // Counters are cleared by any write
+  void begin() {
+    xip_ctrl_hw->ctr_hit = 0;
+    xip_ctrl_hw->ctr_acc = 0;
+  }
+
+  void end() {
+    hit = xip_ctrl_hw->ctr_hit;
+    access = xip_ctrl_hw->ctr_acc;
+  }
+
+  uint32_t hit_rate() const {
+    return access ? (uint64_t) hit * 100 / access : 100;
+  }
+};
@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""Converts PNG images into RLE sprite headers for src/util/sprite.h.
+
+Usage: png2sprite.py [--hot] OUTPUT.h INPUT.png [INPUT.png ...]
+
+Each input becomes a `const Sprite <name>`, named after the file. Only the
+Python standard library is used; 8-bit non-interlaced PNGs are supported
+(grayscale, RGB, palette, grayscale+alpha, RGBA). Pixels whose 4-bit alpha
+is 0 become transparent runs. With --hot, sprite data is placed in SRAM
+(HOT_DATA from src/util/hot.h) instead of being read through the XIP cache.
+"""
+
+import os
+import re
+import struct
+import sys
+import zlib
+
+
+def read_png(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        raise ValueError(f'{path}: not a PNG file')
+
+    pos = 8
+    idat = b''
+    palette = []
+    trns = b''
+    width = height = color_type = None
+
+    while pos < len(data):
+        length, kind = struct.unpack('>I4s', data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+
+        if kind == b'IHDR':
+            width, height, depth, color_type, _, _, interlace = struct.unpack('>IIBBBBB', chunk)
+            if depth != 8 or interlace != 0:
+                raise ValueError(f'{path}: only 8-bit non-interlaced images are supported')
+        elif kind == b'PLTE':
+            palette = [tuple(chunk[i:i + 3]) for i in range(0, len(chunk), 3)]
+        elif kind == b'tRNS':
+            trns = chunk
+        elif kind == b'IDAT':
+            idat += chunk
+        elif kind == b'IEND':
+            break
+
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[color_type]
+    raw = zlib.decompress(idat)
+    stride = width * channels
+    rows = []
+    prev = bytearray(stride)
+
+    for y in range(height):
+        line = raw[y * (stride + 1):(y + 1) * (stride + 1)]
+        kind, cur = line[0], bytearray(line[1:])
+
+        for i in range(stride):
+            a = cur[i - channels] if i >= channels else 0
+            b = prev[i]
+            c = prev[i - channels] if i >= channels else 0
+
+            if kind == 1:
+                cur[i] = (cur[i] + a) & 0xFF
+            elif kind == 2:
+                cur[i] = (cur[i] + b) & 0xFF
+            elif kind == 3:
+                cur[i] = (cur[i] + (a + b) // 2) & 0xFF
+            elif kind == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                cur[i] = (cur[i] + (a if pa <= pb and pa <= pc else b if pb <= pc else c)) & 0xFF
+
+        rows.append(cur)
+        prev = cur
+
+    pixels = []
+    for row in rows:
+        for x in range(width):
+            px = row[x * channels:(x + 1) * channels]
+            if color_type == 0:
+                rgba = (px[0], px[0], px[0], 255)
+            elif color_type == 2:
+                rgba = (px[0], px[1], px[2], 255)
+            elif color_type == 3:
+                rgba = palette[px[0]] + (trns[px[0]] if px[0] < len(trns) else 255,)
+            elif color_type == 4:
+                rgba = (px[0], px[0], px[0], px[1])
+            else:
+                rgba = tuple(px)
+            pixels.append(rgba)
+
+    return width, height, pixels
+
+
+# Same nibble layout as picosystem::rgb()
+def to_color(r, g, b, a):
+    return (r >> 4) | ((a >> 4) << 4) | ((b >> 4) << 8) | ((g >> 4) << 12)
+
+
+def encode(width, height, pixels):
+    rows, data = [], []
+
+    for y in range(height):
+        line = [to_color(*p) for p in pixels[y * width:(y + 1) * width]]
+        rows.append(len(data))
+        x = 0
+
+        while x < width:
+            skip = 0
+            while x + skip < width and not line[x + skip] & 0xF0:
+                skip += 1
+            x += skip
+
+            copy = 0
+            while x + copy < width and line[x + copy] & 0xF0:
+                copy += 1
+
+            data += [skip, copy] + line[x:x + copy]
+            x += copy
+
+    return rows, data
+
+
+def format_array(values):
+    lines = []
+    for i in range(0, len(values), 12):
+        lines.append('  ' + ', '.join(f'0x{v:04X}' for v in values[i:i + 12]) + ',')
+    return '\n'.join(lines)
+
+
+def main():
+    args = sys.argv[1:]
+    hot = '--hot' in args
+    args = [arg for arg in args if arg != '--hot']
+
+    if len(args) < 2:
+        print(__doc__.strip(), file=sys.stderr)
+        return 1
+
+    out = ['// Generated by tools/png2sprite.py, do not edit', '#pragma once', '', '#include "util/sprite.h"', '']
+    attr = 'HOT_DATA("sprites") ' if hot else ''
+
+    for path in args[1:]:
+        name = re.sub(r'\W', '_', os.path.splitext(os.path.basename(path))[0])
+        width, height, pixels = read_png(path)
+        rows, data = encode(width, height, pixels)
+
+        out += [
+            f'{attr}const uint16_t {name}_rows[] = {{', format_array(rows), '};', '',
+            f'{attr}const uint16_t {name}_data[] = {{', format_array(data), '};', '',
+            f'const Sprite {name} = {{{width}, {height}, {name}_rows, {name}_data}};', '',
+        ]
+
+    with open(args[0], 'w') as f:
+        f.write('\n'.join(out))
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())